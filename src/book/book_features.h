@@ -0,0 +1,248 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <book/order_book.h>
+
+// default feature set, see parse_book_features
+constexpr const char* DEFAULT_BOOK_FEATURES = "imbalance:1,5,10;microprice;weighted_spread:5,10;ofi:1,5";
+
+enum class book_feature_kind {
+    imbalance,       // (bid size - ask size) / (bid size + ask size) over the top depth levels
+    microprice,      // size weighted touch price, (ask * bid size + bid * ask size) / (bid size + ask size), bps from the mid
+    weighted_spread, // size weighted average ask - average bid over the top depth levels, bps of the mid
+    order_flow_imbalance // order flow imbalance since the previous book summed over the top depth levels, base units
+};
+
+struct book_feature {
+    book_feature_kind kind;
+    size_t depth; // levels per side, 1 for the microprice
+    std::string name; // e.g. imbalance_5
+};
+
+// Feature set from a spec of groups "kind[:depth,...]" separated by ';', e.g.
+// "imbalance:1,5,10;microprice;weighted_spread:10;ofi:1,5"
+// false on an unknown kind or a malformed or zero depth, features is left unchanged then
+inline bool parse_book_features(std::string_view spec, std::vector<book_feature>& features) {
+    struct kind_name {
+        std::string_view name;
+        book_feature_kind kind;
+        bool has_depth;
+    };
+
+    constexpr kind_name KINDS[] = {
+        {"imbalance", book_feature_kind::imbalance, true},
+        {"microprice", book_feature_kind::microprice, false},
+        {"weighted_spread", book_feature_kind::weighted_spread, true},
+        {"ofi", book_feature_kind::order_flow_imbalance, true}
+    };
+
+    std::vector<book_feature> parsed;
+
+    while(!spec.empty()) {
+        size_t end = std::min(spec.find(';'), spec.size());
+        std::string_view group = spec.substr(0, end);
+        spec.remove_prefix(std::min(end + 1, spec.size()));
+
+        if(group.empty())
+            continue;
+
+        size_t colon = group.find(':');
+        std::string_view kind = group.substr(0, colon);
+
+        const kind_name* match = std::find_if(std::begin(KINDS), std::end(KINDS), [&](const kind_name& k) { return k.name == kind; });
+        if(match == std::end(KINDS))
+            return false;
+
+        if(!match->has_depth) {
+            if(colon != std::string_view::npos)
+                return false;
+
+            parsed.push_back({match->kind, 1, std::string(match->name)});
+            continue;
+        }
+
+        // a depth list is required, e.g. imbalance:5
+        if(colon == std::string_view::npos)
+            return false;
+
+        std::string_view depths = group.substr(colon + 1);
+        if(depths.empty() || depths.back() == ',')
+            return false;
+
+        while(!depths.empty()) {
+            size_t comma = std::min(depths.find(','), depths.size());
+            std::string_view depth_text = depths.substr(0, comma);
+            depths.remove_prefix(std::min(comma + 1, depths.size()));
+
+            // the whole token must be the number, "5x" or "" is malformed
+            size_t depth = 0;
+            auto result = std::from_chars(depth_text.data(), depth_text.data() + depth_text.size(), depth);
+            if(result.ec != std::errc() || result.ptr != depth_text.data() + depth_text.size() || depth == 0)
+                return false;
+
+            parsed.push_back({match->kind, depth, std::string(match->name) + "_" + std::string(depth_text)});
+        }
+    }
+
+    features = std::move(parsed);
+    return true;
+}
+
+// Microstructure features of the book, maintained per update
+// The venues send snapshots, so an update reads the top levels once into running sums per side
+// that every depth of every feature shares, O(max depth) whatever the size of the book; the
+// order flow imbalance compares the levels with the ones kept from the previous book of the
+// same symbol. Nothing allocates after construction
+class book_feature_engine {
+public:
+    book_feature_engine(std::vector<book_feature> features) : m_features{std::move(features)} {
+        for(const auto& feature : m_features) {
+            m_depth = std::max(m_depth, feature.depth);
+            if(feature.kind == book_feature_kind::order_flow_imbalance)
+                m_flow_depth = std::max(m_flow_depth, feature.depth);
+        }
+
+        m_values.assign(m_features.size(), 0);
+
+        m_bid_size.resize(m_depth);
+        m_ask_size.resize(m_depth);
+        m_bid_notional.resize(m_depth);
+        m_ask_notional.resize(m_depth);
+
+        m_flow.resize(m_flow_depth);
+        m_previous_bids.reserve(m_flow_depth);
+        m_previous_asks.reserve(m_flow_depth);
+    }
+
+    // false for an empty side, the values are left unchanged then
+    bool update(const order_book& book) {
+        if(!book.valid())
+            return false;
+
+        accumulate(book.bids, m_bid_size, m_bid_notional);
+        accumulate(book.asks, m_ask_size, m_ask_notional);
+
+        // the flow is only defined between two books of the same instrument
+        bool has_flow = !m_previous_bids.empty() && book.symbol == m_previous_symbol;
+        if(m_flow_depth > 0) {
+            if(has_flow)
+                order_flow(book);
+
+            m_previous_symbol = book.symbol;
+            keep(book.bids, m_previous_bids);
+            keep(book.asks, m_previous_asks);
+        }
+
+        const double mid = book.mid_price();
+
+        for(size_t i = 0; i < m_features.size(); i++) {
+            const book_feature& feature = m_features[i];
+            size_t bid_depth = std::min(feature.depth, book.bids.size()) - 1;
+            size_t ask_depth = std::min(feature.depth, book.asks.size()) - 1;
+
+            double bid_size = m_bid_size[bid_depth];
+            double ask_size = m_ask_size[ask_depth];
+
+            switch(feature.kind) {
+            case book_feature_kind::imbalance:
+                m_values[i] = (bid_size - ask_size) / (bid_size + ask_size + 1e-6);
+                break;
+            case book_feature_kind::microprice:
+                m_values[i] = bid_size + ask_size > 0
+                    ? ((book.best_ask() * bid_size + book.best_bid() * ask_size) / (bid_size + ask_size) - mid) / mid * 1e4 : 0;
+                break;
+            case book_feature_kind::weighted_spread:
+                m_values[i] = bid_size > 0 && ask_size > 0
+                    ? (m_ask_notional[ask_depth] / ask_size - m_bid_notional[bid_depth] / bid_size) / mid * 1e4 : 0;
+                break;
+            case book_feature_kind::order_flow_imbalance:
+                m_values[i] = has_flow ? m_flow[feature.depth - 1] : 0;
+                break;
+            }
+        }
+
+        m_updates++;
+        return true;
+    }
+
+    // forgets the previous book, the next order flow imbalance is 0
+    void reset() {
+        m_previous_bids.clear();
+        m_previous_asks.clear();
+        m_previous_symbol.clear();
+        std::fill(m_values.begin(), m_values.end(), 0);
+        m_updates = 0;
+    }
+
+    const std::vector<book_feature>& features() const { return m_features; }
+
+    // in the order of features()
+    const std::vector<double>& values() const { return m_values; }
+
+    uint64_t updates() const { return m_updates; }
+private:
+    // running sums of the top levels, features deeper than a side read its last sum
+    void accumulate(const std::vector<book_level>& side, std::vector<double>& size, std::vector<double>& notional) {
+        size_t levels = std::min(m_depth, side.size());
+        double total_size = 0, total_notional = 0;
+
+        for(size_t level = 0; level < levels; level++) {
+            total_size += side[level].size;
+            total_notional += side[level].size * side[level].price;
+            size[level] = total_size;
+            notional[level] = total_notional;
+        }
+    }
+
+    // Cont, Kukanov and Stoikov per level, summed over the levels as in the multi level version:
+    // a bid that improved adds its size, one that stayed adds the size change and one that
+    // retreated removes the previous size; asks the other way round
+    void order_flow(const order_book& book) {
+        double total = 0;
+
+        for(size_t level = 0; level < m_flow_depth; level++) {
+            total += level_flow(book.bids, m_previous_bids, level, true) - level_flow(book.asks, m_previous_asks, level, false);
+            m_flow[level] = total;
+        }
+    }
+
+    static double level_flow(const std::vector<book_level>& side, const std::vector<book_level>& previous, size_t level, bool bid) {
+        // a level missing from either book contributes nothing
+        if(level >= side.size() || level >= previous.size())
+            return 0;
+
+        const book_level& now = side[level];
+        const book_level& before = previous[level];
+
+        if(now.price == before.price)
+            return now.size - before.size;
+
+        bool improved = bid ? now.price > before.price : now.price < before.price;
+        return improved ? now.size : -before.size;
+    }
+
+    void keep(const std::vector<book_level>& side, std::vector<book_level>& previous) {
+        previous.assign(side.begin(), side.begin() + std::min(m_flow_depth, side.size()));
+    }
+
+    std::vector<book_feature> m_features;
+    std::vector<double> m_values;
+    size_t m_depth = 0;      // deepest level any feature reads
+    size_t m_flow_depth = 0; // deepest order flow imbalance
+    uint64_t m_updates = 0;
+
+    // cumulative size and size * price of the top levels
+    std::vector<double> m_bid_size, m_ask_size;
+    std::vector<double> m_bid_notional, m_ask_notional;
+
+    // cumulative order flow imbalance of the top levels and the levels it compares against
+    std::vector<double> m_flow;
+    std::vector<book_level> m_previous_bids, m_previous_asks;
+    std::string m_previous_symbol;
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <book/order_book.h>
+
+struct generator_options {
+    double start_mid = 100000;
+    double tick_size = 0.1;
+    int depth = 50;              // levels per side
+    double volatility_bps = 0.5; // stddev of the mid move per update, in basis points
+    double churn = 0.2;          // fraction of the levels whose size changes per update
+    double mean_size = 5;        // mean level size at the touch, grows with distance
+    uint64_t seed = 0;           // 0 picks a random seed
+};
+
+// Evolving L2 book for stress tests: the mid follows a geometric random walk, the touch sits on
+// the tick grid around it and level sizes are redrawn with probability churn per update
+// Sizes are kept by distance from the touch and shifted with it, so a move of the mid keeps
+// the resting levels it did not cross
+class book_generator {
+public:
+    book_generator(std::string exchange, std::string symbol, generator_options options = {})
+        : m_exchange{std::move(exchange)}, m_symbol{std::move(symbol)}, m_options{options},
+          m_rng{options.seed != 0 ? options.seed : std::random_device{}()},
+          m_mid{options.start_mid},
+          m_ask_sizes(options.depth), m_bid_sizes(options.depth) {
+        m_touch = tick_of(m_mid);
+
+        for(int i = 0; i < m_options.depth; i++) {
+            m_ask_sizes[i] = draw_size(i);
+            m_bid_sizes[i] = draw_size(i);
+        }
+    }
+
+    // advances one update and writes the book, reusing its level vectors
+    void next(order_book& book, int64_t exchange_ts_ns = 0) {
+        m_mid *= std::exp(m_options.volatility_bps * 1e-4 * m_normal(m_rng));
+
+        int64_t touch = tick_of(m_mid);
+        shift(touch - m_touch);
+        m_touch = touch;
+
+        for(int i = 0; i < m_options.depth; i++) {
+            if(m_uniform(m_rng) < m_options.churn)
+                m_ask_sizes[i] = draw_size(i);
+            if(m_uniform(m_rng) < m_options.churn)
+                m_bid_sizes[i] = draw_size(i);
+        }
+
+        book.clear();
+        book.exchange = m_exchange;
+        book.symbol = m_symbol;
+        book.exchange_ts_ns = exchange_ts_ns;
+
+        // best bid on the tick at or below the mid, best ask one tick above
+        for(int i = 0; i < m_options.depth; i++) {
+            book.asks.push_back({(m_touch + 1 + i) * m_options.tick_size, m_ask_sizes[i]});
+            book.bids.push_back({(m_touch - i) * m_options.tick_size, m_bid_sizes[i]});
+        }
+    }
+
+    double mid() const { return m_mid; }
+private:
+    int64_t tick_of(double price) const {
+        return (int64_t) std::floor(price / m_options.tick_size);
+    }
+
+    // the touch moved by ticks: levels keep their size, the uncovered ones get fresh sizes
+    void shift(int64_t ticks) {
+        if(ticks == 0)
+            return;
+
+        int depth = m_options.depth;
+        int moved = (int) std::min<int64_t>(std::abs(ticks), depth);
+
+        // up: asks closest to the old touch were crossed, bids gain levels at the front
+        std::vector<double>& shrinking = ticks > 0 ? m_ask_sizes : m_bid_sizes;
+        std::vector<double>& growing = ticks > 0 ? m_bid_sizes : m_ask_sizes;
+
+        std::rotate(shrinking.begin(), shrinking.begin() + moved, shrinking.end());
+        for(int i = depth - moved; i < depth; i++)
+            shrinking[i] = draw_size(i);
+
+        std::rotate(growing.begin(), growing.end() - moved, growing.end());
+        for(int i = 0; i < moved; i++)
+            growing[i] = draw_size(i);
+    }
+
+    // exponential sizes whose mean grows slowly with the distance from the touch, in 0.01 lots
+    double draw_size(int level) {
+        double mean = m_options.mean_size * (1 + 0.05 * level);
+        double size = std::exponential_distribution<double>(1 / mean)(m_rng);
+        return std::max(0.01, std::round(size * 100) / 100);
+    }
+
+    std::string m_exchange;
+    std::string m_symbol;
+    generator_options m_options;
+
+    std::mt19937_64 m_rng;
+    std::normal_distribution<double> m_normal {0, 1};
+    std::uniform_real_distribution<double> m_uniform {0, 1};
+
+    double m_mid;
+    int64_t m_touch; // best bid in ticks
+
+    std::vector<double> m_ask_sizes; // by distance from the touch
+    std::vector<double> m_bid_sizes;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include <book/order_book.h>
+#include <lib/json_writer.h>
+#include <lib/timestamp.h>
+
+// Serializes a native book into the venue wire formats, the inverse of the feed adapters
+// Used by the generators; out is cleared and reused so steady state writes do not allocate
+
+// appends [[p,s],...] with numbers, or quoted decimal strings for quoted = true
+inline void append_book_levels(std::string& out, const std::vector<book_level>& levels, bool quoted) {
+    const char* quote = quoted ? "\"" : "";
+
+    out += '[';
+    for(size_t i = 0; i < levels.size(); i++) {
+        if(i > 0)
+            out += ',';
+
+        out += '[';
+        out += quote; json_append_number(out, levels[i].price); out += quote;
+        out += ',';
+        out += quote; json_append_number(out, levels[i].size); out += quote;
+        out += ']';
+    }
+    out += ']';
+}
+
+// {"timestamp":"...","exchange":"OKX","symbol":"...","asks":[["p","s"],...],"bids":[...]}
+inline void write_okx_book(const order_book& book, std::string& out) {
+    char timestamp[ISO_TIMESTAMP_US_LEN];
+    format_iso_timestamp_us(timestamp, std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(book.exchange_ts_ns))));
+
+    out.clear();
+    out += "{\"timestamp\":\"";
+    out.append(timestamp, ISO_TIMESTAMP_US_LEN);
+    out += "\",\"exchange\":\"OKX\",\"symbol\":";
+    json_append_string(out, book.symbol);
+    out += ",\"asks\":";
+    append_book_levels(out, book.asks, true);
+    out += ",\"bids\":";
+    append_book_levels(out, book.bids, true);
+    out += '}';
+}
+
+// {"ts":<ns>,"sym":"...","a":[[p,s],...],"b":[...]}, see feed/synthetic_adapter.h
+inline void write_synthetic_book(const order_book& book, std::string& out) {
+    out.clear();
+    out += "{\"ts\":";
+    json_append_number(out, book.exchange_ts_ns);
+    out += ",\"sym\":";
+    json_append_string(out, book.symbol);
+    out += ",\"a\":";
+    append_book_levels(out, book.asks, false);
+    out += ",\"b\":";
+    append_book_levels(out, book.bids, false);
+    out += '}';
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct book_level {
+    double price;
+    double size;
+};
+
+// Venue independent L2 snapshot, filled by the feed adapters
+// Vectors are reused across updates, so steady state parsing does not allocate
+struct order_book {
+    std::string exchange;
+    std::string symbol;
+    int64_t exchange_ts_ns = 0; // exchange timestamp, 0 if the venue does not send one
+
+    std::vector<book_level> asks; // ascending price
+    std::vector<book_level> bids; // descending price
+
+    void clear() {
+        exchange_ts_ns = 0;
+        asks.clear();
+        bids.clear();
+    }
+
+    // enforces the side ordering, venues normally send sorted books so this is just a check
+    void normalize() {
+        auto ascending = [](const book_level& a, const book_level& b) { return a.price < b.price; };
+        auto descending = [](const book_level& a, const book_level& b) { return a.price > b.price; };
+
+        if(!std::is_sorted(asks.begin(), asks.end(), ascending))
+            std::sort(asks.begin(), asks.end(), ascending);
+
+        if(!std::is_sorted(bids.begin(), bids.end(), descending))
+            std::sort(bids.begin(), bids.end(), descending);
+    }
+
+    bool valid() const { return !asks.empty() && !bids.empty(); }
+
+    double best_ask() const { return asks.front().price; }
+    double best_bid() const { return bids.front().price; }
+    double mid_price() const { return (best_ask() + best_bid()) / 2; }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const order_book& book) {
+    out << book.exchange << " " << book.symbol << ": "
+        << book.asks.size() << " asks, " << book.bids.size() << " bids";
+
+    if(book.valid())
+        out << ", best " << book.best_bid() << " / " << book.best_ask();
+
+    return out;
+}
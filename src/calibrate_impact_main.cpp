@@ -0,0 +1,185 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <execution/impact_calibration.h>
+#include <feed/capture_file.h>
+#include <feed/feed_registry.h>
+#include <lib/worker_pool.h>
+#include <lib/utilities.h>
+
+std::chrono::time_point<std::chrono::high_resolution_clock> g_timer_start;
+
+// Fits the Almgren-Chriss eta and gamma of an instrument from recorded books (captures from
+// CLIENT_TRADER_RECORD_FILE) and stores them in the parameter file the client loads at startup
+// Each thread accumulates the least squares sums of a contiguous range of messages, the sums
+// are merged at the end; the permanent impact windows opened near the end of a range are
+// completed with the books that follow it
+struct calibrate_options {
+    std::vector<std::string> captures;
+    std::string exchange = "OKX";
+    std::string instrument = "BTC"; // symbol prefix and key in the parameter file
+    double alpha = 1;
+    double beta = 1;
+    double min_usd = 100;
+    double max_usd = 1000000;
+    size_t sizes = 16;
+    size_t horizon = 10;   // books after each book for the permanent impact
+    size_t flow_depth = 1; // levels per side of the order flow imbalance
+    std::string output = "impact_params.json";
+    size_t threads = 0;
+};
+
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [options] <capture.jsonl>...\n"
+        << "  --exchange <OKX|Synthetic>     message format of the capture (default OKX)\n"
+        << "  --instrument <name>            books fitted, by symbol prefix (default BTC)\n"
+        << "  --alpha <x> / --beta <x>       temporary / permanent impact exponents (default 1)\n"
+        << "  --min-usd <x> / --max-usd <x>  range of the order sizes priced per book (default 100 / 1000000)\n"
+        << "  --sizes <n>                    log spaced order sizes per book (default 16)\n"
+        << "  --horizon <n>                  later books the permanent impact is measured over (default 10)\n"
+        << "  --flow-depth <n>               levels per side of the order flow imbalance (default 1)\n"
+        << "  --output <path>                parameter file, other instruments are kept (default impact_params.json)\n"
+        << "  --threads <n>                  0 uses every core (default 0)\n";
+}
+
+int main(int argc, char** argv) {
+    // start global timer
+    g_timer_start = std::chrono::high_resolution_clock::now();
+
+    calibrate_options options;
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if(arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        }
+
+        if(arg.rfind("--", 0) != 0) {
+            options.captures.push_back(arg);
+            continue;
+        }
+
+        if(i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << '\n';
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        std::string value = argv[++i];
+
+        if(arg == "--exchange") options.exchange = value;
+        else if(arg == "--instrument") options.instrument = value;
+        else if(arg == "--alpha") options.alpha = std::stod(value);
+        else if(arg == "--beta") options.beta = std::stod(value);
+        else if(arg == "--min-usd") options.min_usd = std::stod(value);
+        else if(arg == "--max-usd") options.max_usd = std::stod(value);
+        else if(arg == "--sizes") options.sizes = std::max(1ul, std::stoul(value));
+        else if(arg == "--horizon") options.horizon = std::max(1ul, std::stoul(value));
+        else if(arg == "--flow-depth") options.flow_depth = std::max(1ul, std::stoul(value));
+        else if(arg == "--output") options.output = value;
+        else if(arg == "--threads") options.threads = std::stoul(value);
+        else {
+            std::cerr << "Unknown option " << arg << '\n';
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(options.captures.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const feed_adapter* adapter = find_feed_adapter(options.exchange);
+    if(adapter == nullptr) {
+        std::cerr << "Unknown exchange " << options.exchange << '\n';
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    capture_file capture;
+    for(const auto& path : options.captures) {
+        if(!capture.read(path)) {
+            std::cerr << "Cannot read " << path << '\n';
+            return 1;
+        }
+    }
+
+    const auto& messages = capture.messages();
+
+    // log spaced, ascending
+    std::vector<double> sizes_usd(options.sizes);
+    for(size_t i = 0; i < options.sizes; i++)
+        sizes_usd[i] = options.sizes > 1 ? options.min_usd * std::pow(options.max_usd / options.min_usd, static_cast<double>(i) / (options.sizes - 1)) : options.min_usd;
+
+    worker_pool pool {options.threads};
+    std::vector<impact_fit> fits(pool.size());
+    std::vector<size_t> books(pool.size());
+
+    // kernel with unit coefficients, evaluates the regressors v^alpha and v^beta
+    dispatch_impact_kernel({options.alpha, 1, options.beta, 1}, [&](const auto& regressors) {
+        pool.parallel_for(messages.size(), [&](size_t begin, size_t end, size_t chunk) {
+            order_book book;
+            permanent_impact_sampler permanent {options.horizon, options.flow_depth, regressors};
+
+            for(size_t i = begin; i < messages.size(); i++) {
+                bool in_range = i < end;
+                if(!in_range && !permanent.pending())
+                    break;
+
+                if(!adapter->parse(messages[i], book) || !book.valid() || book.symbol.rfind(options.instrument, 0) != 0)
+                    continue;
+
+                if(in_range) {
+                    books[chunk]++;
+                    add_impact_observations(book, sizes_usd.data(), sizes_usd.size(), regressors, fits[chunk]);
+                }
+
+                permanent.add(book, in_range, fits[chunk]);
+            }
+        });
+    });
+
+    impact_fit fit;
+    size_t parsed = 0;
+    for(size_t chunk = 0; chunk < fits.size(); chunk++) {
+        fit.merge(fits[chunk]);
+        parsed += books[chunk];
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if(fit.samples == 0) {
+        std::cerr << "No " << options.instrument << " books in the captures\n";
+        return 1;
+    }
+
+    if(fit.permanent_samples == 0) {
+        std::cerr << "Fewer than " << options.horizon + 1 << " consecutive " << options.instrument << " books, cannot measure the permanent impact\n";
+        return 1;
+    }
+
+    impact_params params {options.alpha, fit.eta(), options.beta, fit.gamma()};
+
+    std::cout << options.instrument << ": " << parsed << " books, " << fit.samples << " samples in " << elapsed << " s ("
+            << pool.size() << " threads)\n"
+        << "  eta   " << params.eta << " (alpha " << params.alpha << ", r2 " << fit.temporary_r2() << ")\n"
+        << "  gamma " << params.gamma << " (beta " << params.beta << ", r2 " << fit.permanent_r2() << ", "
+            << fit.permanent_samples << " windows of " << options.horizon << " books)\n";
+
+    if(!save_impact_params(options.output, options.instrument, params, fit)) {
+        std::cerr << "Cannot write " << options.output << '\n';
+        return 1;
+    }
+
+    std::cout << "  written to " << options.output << '\n';
+    return 0;
+}
@@ -2,14 +2,31 @@
 #include <fstream>
 #include <string>
 #include <memory>
+#include <algorithm>
+#include <cctype>
 
 #include <chrono>
+#include <unordered_map>
 using namespace std::chrono_literals;
 
 #include <websocket/websocket.h>
 #include <client_trader/client_trader.h>
 #include <gui/GUIState.h>
 #include <gui/GUIMain.h>
+#include <feed/feed_registry.h>
+#include <feed/wire_latency.h>
+#include <book/book_features.h>
+#include <model_client/model_client.h>
+#include <model_client/slippage_request.h>
+#include <execution/almgren_chriss.h>
+#include <execution/cost_surface.h>
+#include <execution/execution_monte_carlo.h>
+#include <execution/impact_calibration.h>
+#include <execution/impact_kernels.h>
+#include <execution/maker_taker_model.h>
+#include <execution/realized_volatility.h>
+#include <lib/dependency_graph.h>
+#include <lib/worker_pool.h>
 
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
@@ -17,12 +34,7 @@ using json = nlohmann::json;
 #include <chrono>
 #include <lib/utilities.h>
 #include <lib/benchmark.h>
-
-#include <sys/socket.h>
-#include <arpa/inet.h>
-#include <unistd.h>
-
-constexpr int MAX_SOCKET_BUFFER = 16384;
+#include <lib/config.h>
 
 float g_curr_time = 0;
 float g_last_time = 0;
@@ -34,90 +46,87 @@ InputWindowState g_input_window_state;
 std::chrono::time_point<std::chrono::high_resolution_clock> g_timer_start;
 benchmark g_benchmark {"g_benchmark"};
 
-/// ------------ Socket Initialization ------------
-int socket_client_init() {
-    const char* server_ip = "127.0.0.1";
-    const int server_port = 9000;
-
-    // create socket
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock < 0) {
-        perror("Socket creation failed");
-        return 1;
-    }
-
-    // setup address and parameters
-    sockaddr_in serv_addr{};
-    serv_addr.sin_family = AF_INET;
-    serv_addr.sin_port = htons(server_port);
-
-    if (inet_pton(AF_INET, server_ip, &serv_addr.sin_addr) <= 0) {
-        perror("Invalid address");
-        return 1;
-    }
+/// ------------ Market Impact Calculations ------------
+// the model's exponents are constants, so the kernel is specialized at compile time; eta and
+// gamma are replaced by the selected instrument's calibration if there is one
+using gui_impact_kernel = impact_kernel<exponent_kind_of(InputWindowState::alpha), exponent_kind_of(InputWindowState::beta)>;
 
-    // connect to the server
-    if (connect(sock, (sockaddr*)&serv_addr, sizeof(serv_addr)) < 0) {
-        std::cerr << "Connection failed: " << std::strerror(errno) << std::endl;
-        return 1;
-    } else {
-        std::cout << "Connected to Python server." << std::endl;
-    }
+constexpr impact_params DEFAULT_IMPACT {
+    InputWindowState::alpha, InputWindowState::eta, InputWindowState::beta, InputWindowState::gamma
+};
 
-    return sock;
-}
+gui_impact_kernel g_impact_kernel {DEFAULT_IMPACT};
 
-/// ------------ Market Impact Calculations ------------
 float ac_market_temporary_impact(float volume) {
-    return g_input_window_state.eta * pow(volume, g_input_window_state.alpha);
+    return g_impact_kernel.temporary(volume);
 }
 
 float ac_market_permanent_impact(float volume) {
-    return g_input_window_state.gamma * pow(volume, g_input_window_state.beta);
+    return g_impact_kernel.permanent(volume);
 }
 
 float estimate_market_impact(float volume) {
-    float temp_impact = ac_market_temporary_impact(volume);
-    float perm_impact = ac_market_permanent_impact(volume);
-
-    return temp_impact + perm_impact;
+    return g_impact_kernel(volume);
 }
 
 /// ------------ Slippage Calculations ------------
-json find_expected_slippage(int sock, InputData& input_data) {
-    json request;
-    request["method"] = "expected_slippage";
-
-    request["params"] = json::object();
-    request["params"]["instrument"] = input_data.instrument;
-    request["params"]["order_sz"] = input_data.order_sz;
-    request["params"]["fee_pct"] = input_data.fee_pct;
-    request["params"]["volatility_pct"] = input_data.volatility_pct;
-    request["params"]["asks"] = input_data.live_data["asks"];
-    request["params"]["bids"] = input_data.live_data["bids"];
-
-    // send request
-    std::string req_str = request.dump();
-    send(sock, req_str.c_str(), req_str.size(), 0);
-
-    // receive response
-    char buffer[MAX_SOCKET_BUFFER] = {0};
-    int bytes = recv(sock, buffer, sizeof(buffer) - 1, 0);
-
-    if (bytes > 0) {
-        std::string resp_str(buffer, bytes);
-        json response = json::parse(resp_str);
-        return response;
-    }
+json find_expected_slippage(model_client& models, slippage_request& request, InputData& input_data) {
+    // serialize into the reused request buffer
+    const std::string& req_str = request.write(input_data.instrument, input_data.order_sz,
+        input_data.fee_pct, input_data.volatility_pct, input_data.book);
+
+    // send request and receive response, reconnecting if the server went away
+    if(!models.request(req_str, request.response()))
+        return {};
 
-    return {};
+    return json::parse(request.response(), nullptr, false);
 }
 
 int main() {
     // start global timer
     g_timer_start = std::chrono::high_resolution_clock::now();
 
-    int client_socket = socket_client_init();
+    app_config config = app_config::from_env();
+
+    model_client_options model_options;
+    model_options.host = config.model_host;
+    model_options.port = config.model_port;
+    model_options.connections = config.model_connections;
+    model_options.timeout = std::chrono::milliseconds(config.model_timeout_ms);
+
+    model_client models {model_options};
+    slippage_request slippage_req;
+
+    if(models.ping())
+        APP_LOG(log_flags::client_trader, "Model server is up");
+
+    // native maker/taker model of the selected instrument
+    maker_taker_model maker_taker;
+    auto load_maker_taker = [&](std::string instrument) {
+        std::transform(instrument.begin(), instrument.end(), instrument.begin(), [](unsigned char c) { return std::tolower(c); });
+
+        maker_taker.unload();
+        maker_taker.load(config.maker_taker_dir + "/" + instrument + "_maker_taker.json");
+    };
+
+    // impact parameters of the selected instrument from calibrate_impact
+    impact_params instrument_impact = DEFAULT_IMPACT;
+    auto load_impact = [&](const std::string& instrument) {
+        impact_params params = DEFAULT_IMPACT;
+
+        if(load_impact_params(config.impact_params_file, instrument, params)) {
+            if(params.alpha != DEFAULT_IMPACT.alpha || params.beta != DEFAULT_IMPACT.beta) {
+                APP_LOG(log_flags::client_trader, "Ignoring impact parameters of " << instrument << " calibrated for exponents "
+                    << params.alpha << " / " << params.beta << ", the client uses " << DEFAULT_IMPACT.alpha << " / " << DEFAULT_IMPACT.beta);
+                params = DEFAULT_IMPACT;
+            } else {
+                APP_LOG(log_flags::client_trader, "Impact parameters of " << instrument << ": eta " << params.eta << ", gamma " << params.gamma);
+            }
+        }
+
+        instrument_impact = params;
+        g_impact_kernel = gui_impact_kernel {params};
+    };
 
     // GUI Initialization
     GUIMain gui_main;
@@ -127,14 +136,217 @@ int main() {
     gui_main.fill_input_data_gui(input_data);
     OutputData output_data;
 
+    load_maker_taker(input_data.instrument);
+    load_impact(input_data.instrument);
+
     // Initialize trader class
-    ClientTrader trader;
-    int ws_connection = trader.connect(input_data.instrument);
+    endpoint_options ws_options;
+    ws_options.kernel_timestamps = config.kernel_timestamps;
+    ws_options.message_history = config.message_history;
+    ws_options.io_thread = config.io_thread;
+    ws_options.busy_poll_us = config.busy_poll_us;
+    ws_options.io_spin = config.io_spin;
+
+    ClientTrader trader {ws_options};
+
+    if(!config.ws_base_url.empty())
+        trader.set_base_url("OKX", config.ws_base_url);
+    if(!config.synthetic_ws_base_url.empty())
+        trader.set_base_url("Synthetic", config.synthetic_ws_base_url);
+
+    if(!config.record_file.empty())
+        trader.enable_recording(config.record_file);
+
+    int ws_connection = trader.connect(input_data.exchange, input_data.instrument);
+    const feed_adapter* book_adapter = find_feed_adapter(input_data.exchange);
+
+    // the GUI only needs the newest book, optionally rate limited
+    subscriber_options gui_feed_options;
+    if(config.gui_throttle_ms > 0) {
+        gui_feed_options.policy = conflation_policy::throttle;
+        gui_feed_options.throttle_interval = std::chrono::milliseconds(config.gui_throttle_ms);
+    }
+
+    feed_subscriber::ptr book_feed = trader.subscribe(ws_connection, "gui", gui_feed_options);
+    feed_message book_msg;
 
     // Show connection status
     trader.print_messages(ws_connection);
     benchmark calc_benchmark {"calc_benchmark"};
 
+    // on_message dispatch to finished calculations, for the messages actually processed
+    rolling_latency callback_to_compute;
+
+    // exchange to client latency per connection, from the books' exchange times
+    std::unordered_map<con_id_type, wire_latency> feed_wire_latency;
+
+    // reused across updates
+    ac_schedule ac_plan;
+
+    // costs over sizes x fee tiers, recomputed on every new book
+    worker_pool compute_pool {static_cast<size_t>(std::max(0, config.surface_threads))};
+    cost_surface surface {static_cast<size_t>(std::max(1, config.surface_sizes))};
+    // tail costs of the execution schedule, throttled since a run takes tens of ms
+    execution_monte_carlo cost_simulation;
+    execution_mc_options cost_simulation_options;
+    cost_simulation_options.paths = static_cast<size_t>(std::max(0, config.mc_paths));
+    execution_mc_result cost_distribution;
+    auto last_simulation = std::chrono::steady_clock::time_point {};
+
+    // realized volatility of every instrument seen on the feed
+    const volatility_options volatility_settings {
+        static_cast<double>(config.volatility_halflife_s),
+        static_cast<double>(config.volatility_window_s),
+        config.volatility_sample_ms / 1000.0
+    };
+    std::unordered_map<std::string, realized_volatility> volatility_estimators;
+
+    // microstructure features of the books shown, the order flow imbalance is taken between
+    // consecutive books of the GUI feed (conflated when throttled)
+    std::vector<book_feature> book_feature_set;
+    if(!parse_book_features(config.book_features.empty() ? DEFAULT_BOOK_FEATURES : config.book_features, book_feature_set)) {
+        APP_LOG(log_flags::client_trader, "Invalid book feature set " << config.book_features << ", using " << DEFAULT_BOOK_FEATURES);
+        parse_book_features(DEFAULT_BOOK_FEATURES, book_feature_set);
+    }
+    book_feature_engine book_features {std::move(book_feature_set)};
+
+    // The calculations as a dependency graph, a node only reruns when one of its inputs changed:
+    // a new book does not recompute the fees, a fee tier change does not call the model server
+    dependency_graph calc_graph;
+
+    const auto book_node = calc_graph.add_source("book");
+    const auto order_node = calc_graph.add_source("order size");
+    const auto fee_node = calc_graph.add_source("fee tier");
+    const auto volatility_node = calc_graph.add_source("volatility");
+    const auto schedule_node = calc_graph.add_source("schedule inputs");
+    const auto instrument_node = calc_graph.add_source("instrument models");
+
+    calc_graph.add_node("book features", [&]() {
+        return book_features.update(input_data.book);
+    }, {book_node});
+
+    const auto slippage_node = calc_graph.add_node("slippage", [&]() {
+        if(!input_data.book.valid())
+            return false;
+
+        json j_slippage = find_expected_slippage(models, slippage_req, input_data);
+
+        // keep the last outputs while the model server is unavailable, ask again next frame
+        if(!j_slippage.is_object() || !j_slippage.contains("result")) {
+            calc_graph.retry();
+            return false;
+        }
+
+        output_data.mid_price = j_slippage["result"]["mid_price"].get<float>();
+        output_data.slippage = (j_slippage["result"]["predicted_slippage_pct"].get<float>() * 0.01) * input_data.order_sz;
+        return true;
+    }, {book_node, order_node, volatility_node, instrument_node});
+
+    const auto impact_node = calc_graph.add_node("market impact", [&]() {
+        if(output_data.mid_price <= 0)
+            return false;
+
+        float volume = ((float) input_data.order_sz) / output_data.mid_price;
+        output_data.market_impact = estimate_market_impact(volume) * input_data.order_sz;
+        return true;
+    }, {slippage_node, order_node, instrument_node});
+
+    const auto maker_node = calc_graph.add_node("maker share", [&]() {
+        float maker_proportion = maker_taker.maker_proportion(input_data.book, input_data.order_sz);
+
+        bool changed = maker_proportion != output_data.maker_proportion;
+        output_data.maker_proportion = maker_proportion;
+        return changed;
+    }, {book_node, order_node, instrument_node});
+
+    const auto fees_node = calc_graph.add_node("fees", [&]() {
+        // blended fee rate of the expected maker share
+        float fee_pct = output_data.maker_proportion * input_data.maker_fee_pct + (1 - output_data.maker_proportion) * input_data.fee_pct;
+        output_data.fees = (fee_pct * 0.01) * input_data.order_sz;
+        return true;
+    }, {order_node, fee_node, maker_node});
+
+    calc_graph.add_node("net cost", [&]() {
+        // all three in USD of the order
+        output_data.net_cost = output_data.slippage + output_data.market_impact + output_data.fees;
+        return true;
+    }, {slippage_node, impact_node, fees_node});
+
+    // optimal liquidation of the order over the volatility horizon
+    static_assert(InputWindowState::alpha == 1 && InputWindowState::beta == 1, "the closed form schedule assumes linear impact");
+
+    ac_params execution;
+
+    const auto ac_node = calc_graph.add_node("execution schedule", [&]() {
+        if(output_data.mid_price <= 0 || !input_data.book.valid())
+            return false;
+
+        float mid_price = output_data.mid_price;
+
+        execution.units = ((float) input_data.order_sz) / mid_price;
+        execution.intervals = input_data.ac_intervals;
+        execution.sigma = mid_price * input_data.volatility_pct * 0.01;
+        // the impact model is a fraction of the price, the schedule works in price units
+        execution.eta = instrument_impact.eta * mid_price;
+        execution.gamma = instrument_impact.gamma * mid_price;
+        execution.epsilon = std::max(0.0, (input_data.book.best_ask() - input_data.book.best_bid()) / 2);
+        execution.risk_aversion = input_data.risk_aversion;
+
+        if(execution.units <= 0 || !solve_almgren_chriss(execution, ac_plan))
+            return false;
+
+        output_data.ac_expected_cost = ac_plan.expected_cost;
+        output_data.ac_cost_std = ac_plan.cost_std();
+
+        output_data.ac_holdings.resize(ac_plan.holdings.size());
+        for(size_t i = 0; i < ac_plan.holdings.size(); i++)
+            output_data.ac_holdings[i] = ac_plan.holdings[i] / execution.units;
+        return true;
+    }, {slippage_node, book_node, order_node, volatility_node, schedule_node, instrument_node});
+
+    calc_graph.add_node("cost simulation", [&]() {
+        // throttled, the latest schedule is simulated once the interval is over
+        auto now = std::chrono::steady_clock::now();
+        if(now - last_simulation < std::chrono::milliseconds(config.mc_interval_ms)) {
+            calc_graph.retry();
+            return false;
+        }
+        last_simulation = now;
+
+        const impact_params execution_impact {instrument_impact.alpha, execution.eta, instrument_impact.beta, execution.gamma};
+
+        if(!cost_simulation.simulate(ac_plan.trades, execution, execution_impact, cost_simulation_options, compute_pool, cost_distribution))
+            return false;
+
+        output_data.mc_mean = cost_distribution.mean;
+        output_data.mc_var = cost_distribution.var;
+        output_data.mc_expected_shortfall = cost_distribution.expected_shortfall;
+        output_data.mc_paths = cost_distribution.paths;
+        output_data.mc_time_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - now).count();
+        return true;
+    }, {ac_node});
+
+    // with live volatility the estimate of the book's instrument replaces the slider
+    auto apply_live_volatility = [&]() {
+        auto estimator = volatility_estimators.find(input_data.book.symbol);
+        if(!input_data.live_volatility || estimator == volatility_estimators.end() || estimator->second.returns() == 0)
+            return;
+
+        float volatility_pct = estimator->second.ewma_pct();
+        if(volatility_pct != input_data.volatility_pct) {
+            input_data.volatility_pct = volatility_pct;
+            calc_graph.invalidate(volatility_node);
+        }
+    };
+
+    calc_graph.add_node("cost surface", [&]() {
+        return surface.compute(input_data.book, InputWindowState::fee_pct, instrument_impact, compute_pool);
+    }, {book_node, instrument_node});
+
+    // once the I/O, recorder and compute threads exist, so they do not inherit the main thread's
+    // cpu and policy (they also reset their own placement when they start)
+    apply_thread_tuning(config.main_thread, "main");
+
     while (!gui_main.window_should_close()) {
         gui_main.process_input();
         gui_main.clear_buffers();
@@ -143,8 +355,10 @@ int main() {
         if(g_input_window_state.update_btn_clicked) {
             bool valid_update = true;
 
-            if(g_input_window_state.instrument != input_data.instrument) {
-                // new instrument
+            const char* selected_exchange = gui_main.selected_exchange();
+
+            if(g_input_window_state.instrument != input_data.instrument || input_data.exchange != selected_exchange) {
+                // new instrument or exchange
                 if(std::find(g_input_window_state.allowed_instruments.begin(),
                         g_input_window_state.allowed_instruments.end(), 
                         g_input_window_state.instrument) == g_input_window_state.allowed_instruments.end()) {
@@ -156,15 +370,40 @@ int main() {
                 if(valid_update) {
                     // update input data and setup the new connection
                     g_input_window_state.error_txt = "";
+                    input_data.exchange = selected_exchange;
                     input_data.instrument = g_input_window_state.instrument;
-                    ws_connection = trader.connect(input_data.instrument);
+                    input_data.book.clear();
+
+                    if(book_feed)
+                        trader.unsubscribe(ws_connection, book_feed);
+
+                    ws_connection = trader.connect(input_data.exchange, input_data.instrument);
+                    book_feed = trader.subscribe(ws_connection, "gui", gui_feed_options);
+                    book_adapter = find_feed_adapter(input_data.exchange);
+
+                    load_maker_taker(input_data.instrument);
+                    load_impact(input_data.instrument);
+                    calc_graph.invalidate(instrument_node);
                 }
             } else {
                 g_input_window_state.error_txt = "";
             }
 
             if(valid_update) {
+                InputData previous = input_data;
                 gui_main.fill_input_data_gui(input_data);
+
+                // rerun only what depends on the edited inputs
+                if(input_data.order_sz != previous.order_sz)
+                    calc_graph.invalidate(order_node);
+                if(input_data.fee_pct != previous.fee_pct || input_data.maker_fee_pct != previous.maker_fee_pct)
+                    calc_graph.invalidate(fee_node);
+                if(input_data.volatility_pct != previous.volatility_pct)
+                    calc_graph.invalidate(volatility_node);
+                if(input_data.risk_aversion != previous.risk_aversion || input_data.ac_intervals != previous.ac_intervals)
+                    calc_graph.invalidate(schedule_node);
+
+                apply_live_volatility();
             }
 
             g_input_window_state.update_btn_clicked = false;
@@ -173,33 +412,42 @@ int main() {
         std::cout << g_input_window_state.selected_tier << '\n';
 
         // add the live data
-        auto latest_msg = trader.get_latest_message(ws_connection);
+        bool new_book = book_feed && book_feed->poll(book_msg);
+
+        if(new_book) {
+            // normalize the venue's message into the native book
+            new_book = book_adapter != nullptr && book_adapter->parse(book_msg.payload, input_data.book);
 
-        if(latest_msg != nullptr && !latest_msg->empty()) {
-            json parsed_msg = json::parse(latest_msg->substr(WS_MSG_TYPE_LEN));
-    
-            input_data.live_data["asks"] = std::move(parsed_msg["asks"]);
-            input_data.live_data["bids"] = std::move(parsed_msg["bids"]);
+            if(new_book)
+                feed_wire_latency[ws_connection].record(input_data.book, book_msg.timestamps);
 
             // std::cout << input_data << "\n\n";
         }
 
-        // calc_benchmark.start();
-        // run the calculations only if input data is valid
-        if(input_data.live_data["asks"].size() > 0 && input_data.live_data["bids"].size() > 0) {
-            json j_slippage = find_expected_slippage(client_socket, input_data);
-            float mid_price = j_slippage["result"]["mid_price"].get<float>();
-            float volume = ((float) input_data.order_sz) / mid_price;
-            float market_impact_pct = estimate_market_impact(volume);
+        if(new_book && input_data.book.valid()) {
+            // exchange time, the local arrival time for feeds without one
+            int64_t ts_ns = input_data.book.exchange_ts_ns > 0 ? input_data.book.exchange_ts_ns : book_msg.timestamps.callback_ns;
 
-            output_data.slippage =  (j_slippage["result"]["predicted_slippage_pct"].get<float>() * 0.01) * input_data.order_sz;
-            output_data.market_impact = market_impact_pct * input_data.order_sz;
-            output_data.fees = (input_data.fee_pct * 0.01) * input_data.order_sz;
-            output_data.net_cost = output_data.slippage + output_data.market_impact * output_data.fees;
+            auto& estimator = volatility_estimators.try_emplace(input_data.book.symbol, volatility_settings).first->second;
+            estimator.update(ts_ns, input_data.book.mid_price());
 
-            output_data.mid_price = mid_price;
+            g_input_window_state.realized_volatility_ewma = estimator.ewma_pct();
+            g_input_window_state.realized_volatility_rolling = estimator.rolling_pct();
 
-            // std::cout << output_data << '\n';
+            apply_live_volatility();
+        }
+
+        if(new_book)
+            calc_graph.invalidate(book_node);
+
+        // calc_benchmark.start();
+        calc_graph.run();
+
+        // a book counts as processed once the model server answered for it
+        if(new_book && !calc_graph.dirty(slippage_node)) {
+            int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            callback_to_compute.record(now_ns - book_msg.timestamps.callback_ns);
         }
 
         // calc_benchmark.end();
@@ -207,6 +455,17 @@ int main() {
         gui_main.imgui_new_frame();
         gui_main.imgui_left_window();
         gui_main.imgui_right_window(input_data, output_data);
+        const wire_latency& connection_wire_latency = feed_wire_latency[ws_connection];
+        latency_breakdown feed_latency {
+            connection_wire_latency.summary(),
+            trader.get_kernel_to_callback_latency(ws_connection),
+            callback_to_compute.summary(),
+            connection_wire_latency.resolution_ns() / 1e6
+        };
+        gui_main.imgui_cost_surface_window(surface, g_input_window_state.selected_tier);
+        gui_main.imgui_calculation_window(calc_graph);
+        gui_main.imgui_book_features_window(book_features);
+        gui_main.imgui_feed_window(trader.get_feed_stats(ws_connection), feed_latency, config.wire_latency_alert_ms);
         gui_main.imgui_render();
 
         gui_main.window_swap_buffers();
@@ -215,7 +474,5 @@ int main() {
         gui_main.calc_frame_times();
     }
 
-    close(client_socket);
-
     return 0;
 }
\ No newline at end of file
@@ -1,38 +1,96 @@
 #pragma once
 
 #include <websocket/websocket.h>
+#include <websocket/feed_recorder.h>
 #include <gui/GUIState.h>
+#include <lib/config.h>
+#include <feed/feed_registry.h>
 
 extern InputWindowState g_input_window_state;
 
 class ClientTrader {
 public:
-    con_id_type connect(std::string instrument) {
-        auto it = m_con_map.find(instrument);
+    ClientTrader(endpoint_options options = {}): m_endpoint{options} {}
+
+    // overrides the adapter's default base url, wss:// (production) or ws:// (local replay servers)
+    void set_base_url(const std::string& exchange, std::string base_url) {
+        m_base_urls[exchange] = std::move(base_url);
+    }
+
+    // one connection per (exchange, instrument), reused when already open
+    con_id_type connect(const std::string& exchange, const std::string& instrument) {
+        std::string key = exchange + ":" + instrument;
+
+        auto it = m_con_map.find(key);
         if(it != m_con_map.end()) {
             APP_LOG(log_flags::client_trader, "Instrument already connected");
             return it->second;
         }
 
-        const static std::string base_url = "wss://ws.gomarket-cpp.goquant.io/ws/l2-orderbook/okx/";
+        const feed_adapter* adapter = find_feed_adapter(exchange);
+        if(adapter == nullptr) {
+            APP_LOG(log_flags::client_trader, "Unsupported exchange specified");
+            return -1;
+        }
 
         if(std::find(g_input_window_state.allowed_instruments.begin(), g_input_window_state.allowed_instruments.end(), instrument) == g_input_window_state.allowed_instruments.end()) {
             APP_LOG(log_flags::client_trader, "Incorrect instrument specified");
             return -1;
         }
 
-        std::string url = base_url + instrument + "-USDT-SWAP";
+        auto base_url_it = m_base_urls.find(exchange);
+        std::string base_url = base_url_it != m_base_urls.end() ? base_url_it->second : adapter->default_base_url();
+
+        std::string url = adapter->endpoint_url(base_url, instrument);
         con_id_type id = m_endpoint.connect(url);
 
+        if(id == WS_CON_ERR_CODE) {
+            APP_LOG(log_flags::client_trader, "Failed to connect to " << url);
+            return id;
+        }
+
+        if(m_recorder)
+            m_endpoint.subscribe(id, m_recorder->subscriber());
+
         // add delay to wait for messages to start
         std::this_thread::sleep_for(200ms);
 
-        m_con_map[instrument] = id;
+        m_con_map[key] = id;
         return id;
     }
 
-    std::string* get_latest_message(con_id_type id) {
-        return m_endpoint.get_latest_message(id);
+    // consumer of the instrument's book stream with its own conflation policy
+    feed_subscriber::ptr subscribe(con_id_type id, std::string name, subscriber_options options = {}) {
+        return m_endpoint.subscribe(id, std::move(name), options);
+    }
+
+    void unsubscribe(con_id_type id, const feed_subscriber::ptr& subscriber) {
+        m_endpoint.unsubscribe(id, subscriber);
+    }
+
+    // capture every message of the current and future connections, without drops
+    // false if the capture file cannot be opened, nothing is recorded then
+    bool enable_recording(const std::string& path) {
+        auto recorder = std::make_unique<feed_recorder>(path);
+        if(!recorder->is_open()) {
+            m_recorder.reset();
+            return false;
+        }
+
+        m_recorder = std::move(recorder);
+
+        for(const auto& [key, id] : m_con_map)
+            m_endpoint.subscribe(id, m_recorder->subscriber());
+
+        return true;
+    }
+
+    feed_stats get_feed_stats(con_id_type id) const {
+        return m_endpoint.get_feed_stats(id);
+    }
+
+    latency_summary get_kernel_to_callback_latency(con_id_type id) const {
+        return m_endpoint.get_kernel_to_callback_latency(id);
     }
 
     void print_messages(con_id_type id) {
@@ -44,6 +102,10 @@ public:
             APP_PRINT(*metadata_ptr);
     }
 protected:
-    std::unordered_map<std::string, con_id_type> m_con_map;
+    std::unordered_map<std::string, std::string> m_base_urls; // exchange -> base url
+    std::unordered_map<std::string, con_id_type> m_con_map; // "exchange:instrument" -> connection
+
+    // declared before the endpoint so it drains after the I/O thread has stopped
+    std::unique_ptr<feed_recorder> m_recorder;
     websocket_endpoint m_endpoint;
 };
\ No newline at end of file
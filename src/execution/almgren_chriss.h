@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+// Almgren-Chriss optimal liquidation with linear impact (alpha = beta = 1):
+// permanent impact g(v) = gamma * v, temporary impact h(v) = epsilon + eta * v
+// Selling X units over horizon T in N equal intervals of tau = T / N, the schedule minimizing
+// E[cost] + lambda * Var[cost] holds x_j = X * sinh(kappa (T - t_j)) / sinh(kappa T) after
+// interval j, with kappa from (2 / tau^2) (cosh(kappa tau) - 1) = lambda sigma^2 / eta~ and
+// eta~ = eta - gamma tau / 2 (Almgren & Chriss 2000, section 2)
+struct ac_params {
+    double units = 0;      // X, quantity to liquidate
+    double horizon = 1;    // T, in the time unit of sigma
+    int intervals = 100;   // N
+    double sigma = 0;      // price volatility per sqrt(time unit), absolute
+    double eta = 0;        // temporary impact per unit of trading rate
+    double gamma = 0;      // permanent impact per unit traded
+    double epsilon = 0;    // fixed temporary cost per unit, e.g. half the spread
+    double risk_aversion = 0; // lambda, 0 gives the risk neutral straight line schedule
+};
+
+// buffers are reused across solves, so rerunning on every book update does not allocate
+struct ac_schedule {
+    std::vector<double> holdings; // x_0 = X ... x_N = 0, N + 1 points
+    std::vector<double> trades;   // n_j = x_{j-1} - x_j, N intervals
+
+    double kappa = 0;
+    double expected_cost = 0; // E[cost] relative to the pre-trade mid, price x units
+    double variance = 0;      // Var[cost]
+
+    double cost_std() const { return std::sqrt(variance); }
+};
+
+// false if the parameters are degenerate (no intervals or eta~ <= 0)
+inline bool solve_almgren_chriss(const ac_params& params, ac_schedule& out) {
+    const int n = params.intervals;
+    if(n <= 0 || params.horizon <= 0)
+        return false;
+
+    const double tau = params.horizon / n;
+    const double eta_tilde = params.eta - params.gamma * tau / 2;
+    if(eta_tilde <= 0)
+        return false;
+
+    const double kappa_tilde_sq = params.risk_aversion * params.sigma * params.sigma / eta_tilde;
+    out.kappa = std::acosh(1 + kappa_tilde_sq * tau * tau / 2) / tau;
+
+    out.holdings.resize(n + 1);
+    out.trades.resize(n);
+
+    // sinh ratio in exponential form, which stays finite for large kappa T:
+    // sinh(k (T - t)) / sinh(k T) = e^{-k t} (1 - e^{-2k (T - t)}) / (1 - e^{-2k T})
+    const double kT = out.kappa * params.horizon;
+    const bool straight_line = kT < 1e-9;
+    const double denominator = straight_line ? 1 : -std::expm1(-2 * kT);
+
+    for(int j = 0; j <= n; j++) {
+        double t = j * tau;
+
+        double fraction;
+        if(straight_line)
+            fraction = 1 - static_cast<double>(j) / n;
+        else
+            fraction = std::exp(-out.kappa * t) * -std::expm1(-2 * out.kappa * (params.horizon - t)) / denominator;
+
+        out.holdings[j] = params.units * fraction;
+    }
+    out.holdings[n] = 0;
+
+    // E = gamma X^2 / 2 + epsilon sum |n_j| + (eta~ / tau) sum n_j^2, Var = sigma^2 tau sum_{j>=1} x_j^2
+    double traded = 0, traded_sq = 0, held_sq = 0;
+    for(int j = 1; j <= n; j++) {
+        double trade = out.holdings[j - 1] - out.holdings[j];
+        out.trades[j - 1] = trade;
+
+        traded += std::abs(trade);
+        traded_sq += trade * trade;
+        held_sq += out.holdings[j] * out.holdings[j];
+    }
+
+    out.expected_cost = params.gamma * params.units * params.units / 2
+        + params.epsilon * traded
+        + eta_tilde / tau * traded_sq;
+    out.variance = params.sigma * params.sigma * tau * held_sq;
+
+    return true;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <book/order_book.h>
+#include <execution/impact_kernels.h>
+#include <lib/worker_pool.h>
+
+constexpr size_t COST_SURFACE_TIERS = 5;
+constexpr size_t COST_SURFACE_SIZES = 256;
+constexpr double COST_SURFACE_MIN_USD = 10;
+constexpr double COST_SURFACE_MAX_USD = 10000000;
+
+// Costs of a market buy over a grid of order sizes for every fee tier, in USD
+// Slippage walks the ask side like the model's training label (src/models/utils.py), the
+// book is prepared once (cumulative depth) and every size is then priced independently, so
+// the grid is split across the worker pool
+class cost_surface {
+public:
+    struct cell {
+        double slippage;
+        double impact;
+        double fees;
+        double net_cost;
+    };
+
+    // log spaced sizes in USD
+    cost_surface(size_t sizes = COST_SURFACE_SIZES, double min_usd = COST_SURFACE_MIN_USD, double max_usd = COST_SURFACE_MAX_USD)
+        : m_sizes(sizes), m_volumes(sizes), m_impact(sizes), m_cells(sizes * COST_SURFACE_TIERS), m_exhausted(sizes) {
+        for(size_t i = 0; i < sizes; i++)
+            m_sizes[i] = sizes > 1 ? min_usd * std::pow(max_usd / min_usd, static_cast<double>(i) / (sizes - 1)) : min_usd;
+    }
+
+    // recomputes every cell, false if the book has no two sided quote
+    bool compute(const order_book& book, const float (&fee_pct)[COST_SURFACE_TIERS], const impact_params& impact, worker_pool& pool) {
+        if(!book.valid())
+            return false;
+
+        m_mid = book.mid_price();
+
+        // cumulative quantity and notional through each ask level
+        size_t levels = book.asks.size();
+        m_cum_qty.resize(levels);
+        m_cum_notional.resize(levels);
+
+        double qty = 0, notional = 0;
+        for(size_t i = 0; i < levels; i++) {
+            qty += book.asks[i].size;
+            notional += book.asks[i].price * book.asks[i].size;
+            m_cum_qty[i] = qty;
+            m_cum_notional[i] = notional;
+        }
+
+        // the exponents are resolved once per update, each chunk then runs the specialized
+        // kernel over its slice of volumes
+        dispatch_impact_kernel(impact, [&](const auto& kernel) {
+            pool.parallel_for(m_sizes.size(), [&](size_t begin, size_t end, size_t) {
+                for(size_t i = begin; i < end; i++)
+                    m_volumes[i] = m_sizes[i] / m_mid;
+
+                kernel.evaluate(m_volumes.data() + begin, m_impact.data() + begin, end - begin);
+
+                for(size_t i = begin; i < end; i++)
+                    price_size(i, book, fee_pct);
+            });
+        });
+
+        return true;
+    }
+
+    size_t sizes() const { return m_sizes.size(); }
+    double size_usd(size_t i) const { return m_sizes[i]; }
+
+    const cell& at(size_t size_index, size_t tier) const { return m_cells[tier * m_sizes.size() + size_index]; }
+
+    // the ask side was shorter than the order, the rest is priced at the last level
+    bool exhausted(size_t size_index) const { return m_exhausted[size_index]; }
+
+    double mid_price() const { return m_mid; }
+private:
+    void price_size(size_t i, const order_book& book, const float (&fee_pct)[COST_SURFACE_TIERS]) {
+        double size_usd = m_sizes[i];
+        double volume = m_volumes[i];
+
+        // first level whose cumulative depth covers the order
+        size_t level = std::lower_bound(m_cum_qty.begin(), m_cum_qty.end(), volume) - m_cum_qty.begin();
+        m_exhausted[i] = level == m_cum_qty.size();
+        level = std::min(level, m_cum_qty.size() - 1);
+
+        double filled_before = level > 0 ? m_cum_qty[level - 1] : 0;
+        double notional_before = level > 0 ? m_cum_notional[level - 1] : 0;
+        double cost = notional_before + (volume - filled_before) * book.asks[level].price;
+
+        double slippage = (cost / volume - m_mid) / m_mid * size_usd;
+        double impact_usd = m_impact[i] * size_usd;
+
+        for(size_t tier = 0; tier < COST_SURFACE_TIERS; tier++) {
+            double fees = fee_pct[tier] * 0.01 * size_usd;
+            m_cells[tier * m_sizes.size() + i] = {slippage, impact_usd, fees, slippage + impact_usd + fees};
+        }
+    }
+
+    std::vector<double> m_sizes;
+    std::vector<double> m_volumes; // base quantity of each size at the current mid
+    std::vector<double> m_impact;  // impact fraction of each size
+    std::vector<cell> m_cells; // tier major
+    std::vector<char> m_exhausted;
+
+    std::vector<double> m_cum_qty;
+    std::vector<double> m_cum_notional;
+
+    double m_mid = 0;
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <execution/almgren_chriss.h>
+#include <execution/impact_kernels.h>
+#include <lib/fast_random.h>
+#include <lib/worker_pool.h>
+
+// paths simulated together, the per interval updates run over a block as plain vector loops
+constexpr size_t EXECUTION_MC_BLOCK = 256;
+
+struct execution_mc_options {
+    size_t paths = 100000;
+    double confidence = 0.95; // VaR and expected shortfall level
+    uint64_t seed = 1;
+};
+
+struct execution_mc_result {
+    size_t paths = 0;
+    double mean = 0;
+    double std = 0;
+    double var = 0; // cost exceeded with probability 1 - confidence
+    double expected_shortfall = 0; // mean cost beyond var
+};
+
+// Distribution of the cost of trading a schedule under the Almgren-Chriss price dynamics:
+// over interval k of length tau the order trades n_k at S_{k-1} + epsilon + h(n_k / tau) and
+// the price moves by sigma sqrt(tau) xi_k + tau g(n_k / tau), with h and g the temporary and
+// permanent impact of impact_params. The cost is the shortfall against the arrival price.
+// Paths are independent, every block of paths has its own generator seeded from the block
+// index, so results do not depend on the number of threads
+class execution_monte_carlo {
+public:
+    // trades from solve_almgren_chriss, same units and time unit as params
+    bool simulate(const std::vector<double>& trades, const ac_params& params, const impact_params& impact,
+            const execution_mc_options& options, worker_pool& pool, execution_mc_result& out) {
+        const size_t intervals = trades.size();
+        if(intervals == 0 || options.paths == 0 || params.horizon <= 0)
+            return false;
+
+        const double tau = params.horizon / intervals;
+        const double shock = params.sigma * std::sqrt(tau);
+
+        // deterministic per interval terms
+        m_execution_cost.resize(intervals);
+        m_price_drift.resize(intervals);
+
+        dispatch_impact_kernel(impact, [&](const auto& kernel) {
+            for(size_t k = 0; k < intervals; k++) {
+                double rate = std::abs(trades[k]) / tau;
+                m_execution_cost[k] = trades[k] * (params.epsilon + kernel.temporary(rate));
+                m_price_drift[k] = tau * kernel.permanent(rate);
+            }
+        });
+
+        m_costs.resize(options.paths);
+        size_t blocks = (options.paths + EXECUTION_MC_BLOCK - 1) / EXECUTION_MC_BLOCK;
+
+        pool.parallel_for(blocks, [&](size_t begin, size_t end, size_t) {
+            for(size_t block = begin; block < end; block++) {
+                size_t first = block * EXECUTION_MC_BLOCK;
+                size_t count = std::min(EXECUTION_MC_BLOCK, options.paths - first);
+                simulate_block(trades, shock, options.seed, block, &m_costs[first], count);
+            }
+        });
+
+        summarize(options, out);
+        return true;
+    }
+private:
+    void simulate_block(const std::vector<double>& trades, double shock, uint64_t seed, size_t block, double* costs, size_t count) const {
+        uint64_t block_seed = seed ^ (block * 0xd1342543de82ef95ull);
+        xoshiro256 rng {splitmix64(block_seed)};
+
+        double drift[EXECUTION_MC_BLOCK]; // S - S_0 of each path
+        double noise[EXECUTION_MC_BLOCK];
+
+        std::fill(drift, drift + count, 0.0);
+        std::fill(costs, costs + count, 0.0);
+
+        for(size_t k = 0; k < trades.size(); k++) {
+            const double trade = trades[k];
+            const double execution = m_execution_cost[k];
+            const double move = m_price_drift[k];
+
+            for(size_t p = 0; p < count; p++)
+                noise[p] = s_normal(rng);
+
+            for(size_t p = 0; p < count; p++) {
+                costs[p] += trade * drift[p] + execution;
+                drift[p] += shock * noise[p] + move;
+            }
+        }
+    }
+
+    void summarize(const execution_mc_options& options, execution_mc_result& out) {
+        const size_t n = m_costs.size();
+
+        double sum = 0, sum_sq = 0;
+        for(double cost : m_costs) {
+            sum += cost;
+            sum_sq += cost * cost;
+        }
+
+        out.paths = n;
+        out.mean = sum / n;
+        out.std = std::sqrt(std::max(0.0, sum_sq / n - out.mean * out.mean));
+
+        // the worst (1 - confidence) share of the paths sits above the var
+        size_t tail = std::max<size_t>(1, static_cast<size_t>(std::ceil(n * (1 - options.confidence))));
+        auto var = m_costs.end() - tail;
+        std::nth_element(m_costs.begin(), var, m_costs.end());
+
+        double tail_sum = 0;
+        for(auto it = var; it != m_costs.end(); ++it)
+            tail_sum += *it;
+
+        out.var = *var;
+        out.expected_shortfall = tail_sum / tail;
+    }
+
+    inline static const normal_ziggurat s_normal {};
+
+    std::vector<double> m_execution_cost;
+    std::vector<double> m_price_drift;
+    std::vector<double> m_costs;
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <book/order_book.h>
+
+enum class order_side { buy, sell };
+
+// what a decrease of the resting size at our price means for the orders queued ahead of us;
+// L2 books do not show trades or where in the queue a cancel happened
+enum class queue_model {
+    pro_rata, // decreases are spread over the queue, only the share ahead of us moves us up
+    front     // decreases are fills from the front of the queue, an optimistic bound
+};
+
+struct limit_order {
+    order_side side = order_side::buy;
+    double price = 0;
+    double qty = 0;         // base units
+    int64_t ttl_ns = 0;     // cancelled after this long in exchange time
+};
+
+struct fill_record {
+    limit_order order;
+    int64_t placed_ns = 0;
+    double filled = 0;
+    int64_t first_fill_ns = -1; // -1 if never touched
+    int64_t complete_ns = -1;   // -1 if not completely filled before the ttl
+
+    bool complete() const { return complete_ns >= 0; }
+};
+
+// Hypothetical limit orders resting in a sequence of books, with queue position tracking:
+// an order joins the back of its price level, the level's later decreases move it up the queue
+// (see queue_model) and opposite side liquidity at or through its price fills the queue ahead
+// first, then the order. Orders never affect the books
+class fill_simulator {
+public:
+    explicit fill_simulator(queue_model model = queue_model::pro_rata): m_model{model} {}
+
+    // places the order behind the size currently resting at its price
+    void place(const order_book& book, const limit_order& order) {
+        active_order active;
+        active.record.order = order;
+        active.record.placed_ns = book.exchange_ts_ns;
+        active.level_size = level_size(own_side(book, order.side), order.side, order.price);
+        active.ahead = active.level_size;
+
+        m_active.push_back(active);
+        update_order(m_active.back(), book);
+    }
+
+    // advances every active order to the next book, finished orders move to completed()
+    void update(const order_book& book) {
+        for(size_t i = 0; i < m_active.size();) {
+            active_order& active = m_active[i];
+
+            bool expired = book.exchange_ts_ns - active.record.placed_ns > active.record.order.ttl_ns;
+            if(!expired)
+                update_order(active, book);
+
+            if(expired || active.record.complete()) {
+                m_completed.push_back(active.record);
+                active = m_active.back();
+                m_active.pop_back();
+            } else {
+                i++;
+            }
+        }
+    }
+
+    // ends the run, orders still resting count as unfilled
+    void finish() {
+        for(const auto& active : m_active)
+            m_completed.push_back(active.record);
+        m_active.clear();
+    }
+
+    size_t active() const { return m_active.size(); }
+    const std::vector<fill_record>& completed() const { return m_completed; }
+private:
+    struct active_order {
+        fill_record record;
+        double ahead = 0;      // resting size ahead of the order
+        double level_size = 0; // size at the order's price in the previous book
+        double crossing = 0;   // opposite side size at or through the price in the previous book
+    };
+
+    static const std::vector<book_level>& own_side(const order_book& book, order_side side) {
+        return side == order_side::buy ? book.bids : book.asks;
+    }
+
+    static const std::vector<book_level>& opposite_side(const order_book& book, order_side side) {
+        return side == order_side::buy ? book.asks : book.bids;
+    }
+
+    // size at exactly price on a normalized side, 0 if the level is absent
+    static double level_size(const std::vector<book_level>& levels, order_side side, double price) {
+        auto it = side == order_side::buy
+            ? std::lower_bound(levels.begin(), levels.end(), price, [](const book_level& level, double p) { return level.price > p; })
+            : std::lower_bound(levels.begin(), levels.end(), price, [](const book_level& level, double p) { return level.price < p; });
+
+        return it != levels.end() && it->price == price ? it->size : 0;
+    }
+
+    // opposite side size priced at or through the order
+    static double crossing_size(const std::vector<book_level>& levels, order_side side, double price) {
+        double size = 0;
+        for(const auto& level : levels) {
+            if(side == order_side::buy ? level.price > price : level.price < price)
+                break;
+            size += level.size;
+        }
+        return size;
+    }
+
+    void update_order(active_order& active, const order_book& book) {
+        const limit_order& order = active.record.order;
+
+        // queue movement from the change of the resting size
+        double size = level_size(own_side(book, order.side), order.side, order.price);
+        double decrease = active.level_size - size;
+
+        double traded = 0;
+        if(decrease > 0) {
+            double advance = m_model == queue_model::front ? decrease : decrease * active.ahead / active.level_size;
+            double consumed = std::min(active.ahead, advance);
+            active.ahead -= consumed;
+
+            if(m_model == queue_model::front)
+                traded = decrease - consumed;
+        }
+        active.level_size = size;
+
+        // opposite side liquidity at our price would have matched the queue ahead, then us;
+        // only its growth is new, a book that stays crossed is not traded again
+        double crossing = crossing_size(opposite_side(book, order.side), order.side, order.price);
+        double new_crossing = std::max(0.0, crossing - active.crossing);
+        active.crossing = crossing;
+
+        if(new_crossing > 0) {
+            double consumed = std::min(active.ahead, new_crossing);
+            active.ahead -= consumed;
+            traded += new_crossing - consumed;
+        }
+
+        fill(active, traded, book.exchange_ts_ns);
+    }
+
+    static void fill(active_order& active, double traded, int64_t ts_ns) {
+        fill_record& record = active.record;
+
+        double fill = std::min(traded, record.order.qty - record.filled);
+        if(fill <= 0)
+            return;
+
+        record.filled += fill;
+        if(record.first_fill_ns < 0)
+            record.first_fill_ns = ts_ns;
+        if(record.filled >= record.order.qty)
+            record.complete_ns = ts_ns;
+    }
+
+    queue_model m_model;
+
+    std::vector<active_order> m_active;
+    std::vector<fill_record> m_completed;
+};
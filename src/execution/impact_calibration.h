@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <book/book_features.h>
+#include <book/order_book.h>
+#include <execution/impact_kernels.h>
+
+// Fit of eta and gamma from recorded books, for fixed exponents
+//   temporary  every book prices market buys of several sizes v (base units),
+//              (average fill - best ask) / mid, modelled as eta * v^alpha
+//   permanent  the mid change over the following books against the signed flow f (base units)
+//              of the same books, modelled as gamma * sign(f) * |f|^beta (permanent_impact_sampler)
+// Both are least squares fits through the origin, accumulated as sums that several threads
+// fill independently and merge
+struct impact_fit {
+    // normal equations of y = k * x
+    double temporary_xx = 0, temporary_xy = 0, temporary_yy = 0;
+    double permanent_xx = 0, permanent_xy = 0, permanent_yy = 0;
+    size_t samples = 0;           // temporary, one per book and size
+    size_t permanent_samples = 0; // one per book window
+
+    void merge(const impact_fit& other) {
+        temporary_xx += other.temporary_xx;
+        temporary_xy += other.temporary_xy;
+        temporary_yy += other.temporary_yy;
+        permanent_xx += other.permanent_xx;
+        permanent_xy += other.permanent_xy;
+        permanent_yy += other.permanent_yy;
+        samples += other.samples;
+        permanent_samples += other.permanent_samples;
+    }
+
+    double eta() const { return temporary_xx > 0 ? temporary_xy / temporary_xx : 0; }
+    double gamma() const { return permanent_xx > 0 ? permanent_xy / permanent_xx : 0; }
+
+    // share of the sum of squares explained by the fit (uncentered, the fit has no intercept)
+    double temporary_r2() const { return temporary_yy > 0 ? temporary_xy * eta() / temporary_yy : 0; }
+    double permanent_r2() const { return permanent_yy > 0 ? permanent_xy * gamma() / permanent_yy : 0; }
+};
+
+// adds the temporary impact of one book for ascending sizes, the ones deeper than the book are skipped
+// regressors is a kernel with eta = gamma = 1, giving v^alpha and v^beta
+template<class Kernel>
+void add_impact_observations(const order_book& book, const double* sizes_usd, size_t sizes, const Kernel& regressors, impact_fit& fit) {
+    if(!book.valid())
+        return;
+
+    const double mid = book.mid_price();
+    const double best_ask = book.best_ask();
+
+    for(size_t s = 0; s < sizes; s++) {
+        double volume = sizes_usd[s] / mid;
+
+        // walk the asks
+        double filled = 0, cost = 0;
+        for(size_t level = 0; level < book.asks.size() && filled < volume; level++) {
+            double take = std::min(book.asks[level].size, volume - filled);
+            filled += take;
+            cost += take * book.asks[level].price;
+        }
+
+        if(filled < volume)
+            return; // deeper than the book, so are the larger sizes
+
+        double temporary = (cost / volume - best_ask) / mid;
+        double x_temporary = regressors.temporary(volume);
+
+        fit.temporary_xx += x_temporary * x_temporary;
+        fit.temporary_xy += x_temporary * temporary;
+        fit.temporary_yy += temporary * temporary;
+        fit.samples++;
+    }
+}
+
+// Permanent impact from the mid over the books that follow each book
+// A single snapshot only shows what an order would consume, not where the price settles, so
+// every book opens a window of horizon books and the relative mid change over the window is
+// regressed on the order flow imbalance summed over the same books (Cont, Kukanov and Stoikov):
+// the net signed volume added at the bid and removed at the ask, trades and cancels included,
+// that moved the price. The books are fed in capture order; a change of symbol starts over
+template<class Kernel>
+class permanent_impact_sampler {
+public:
+    permanent_impact_sampler(size_t horizon, size_t flow_depth, const Kernel& regressors)
+        : m_flow{{{book_feature_kind::order_flow_imbalance, std::max<size_t>(1, flow_depth), "ofi"}}},
+          m_window(std::max<size_t>(1, horizon)), m_regressors{regressors} {}
+
+    // adds the window the book closes; opens_window is false for books that only complete the
+    // windows of earlier ones (past the end of a thread's range)
+    void add(const order_book& book, bool opens_window, impact_fit& fit) {
+        if(!book.valid())
+            return;
+
+        if(book.symbol != m_symbol) {
+            m_flow.reset();
+            m_symbol = book.symbol;
+            m_count = 0;
+            m_opened = 0;
+        }
+
+        m_flow.update(book);
+        m_total_flow += m_flow.values()[0];
+
+        size_t slot = (m_first + m_count) % m_window.size();
+
+        if(m_count == m_window.size()) {
+            const window_book& start = m_window[m_first];
+
+            if(start.opens_window) {
+                double y = (book.mid_price() - start.mid) / start.mid;
+                double flow = m_total_flow - start.total_flow;
+                double x = std::copysign(m_regressors.permanent(std::abs(flow)), flow);
+
+                fit.permanent_xx += x * x;
+                fit.permanent_xy += x * y;
+                fit.permanent_yy += y * y;
+                fit.permanent_samples++;
+                m_opened--;
+            }
+
+            slot = m_first;
+            m_first = (m_first + 1) % m_window.size();
+            m_count--;
+        }
+
+        m_window[slot] = {book.mid_price(), m_total_flow, opens_window};
+        m_count++;
+        m_opened += opens_window;
+    }
+
+    // a window opened by an earlier book still needs later ones
+    bool pending() const { return m_opened > 0; }
+private:
+    struct window_book {
+        double mid;
+        double total_flow; // flow summed up to and including this book
+        bool opens_window;
+    };
+
+    book_feature_engine m_flow;
+    std::string m_symbol;
+    double m_total_flow = 0;
+
+    // the last horizon books, oldest at m_first
+    std::vector<window_book> m_window;
+    size_t m_first = 0, m_count = 0;
+    size_t m_opened = 0;
+
+    const Kernel& m_regressors;
+};
+
+// Parameter file shared by the calibration tool and the client, one entry per instrument:
+// {"BTC": {"alpha": 1, "eta": ..., "beta": 1, "gamma": ..., "samples": ...}, ...}
+inline nlohmann::json read_impact_file(const std::string& path) {
+    std::ifstream in(path);
+    if(!in)
+        return nlohmann::json::object();
+
+    nlohmann::json file = nlohmann::json::parse(in, nullptr, false);
+    return file.is_object() ? file : nlohmann::json::object();
+}
+
+// false if the file has no usable entry for the instrument, params are left unchanged then
+inline bool load_impact_params(const std::string& path, const std::string& instrument, impact_params& params) {
+    nlohmann::json file = read_impact_file(path);
+    if(!file.contains(instrument))
+        return false;
+
+    // the file is edited by hand, value() throws on a mistyped entry or parameter
+    const auto& entry = file[instrument];
+    if(!entry.is_object())
+        return false;
+
+    impact_params loaded = params;
+    const std::pair<const char*, double*> fields[] = {
+        {"alpha", &loaded.alpha}, {"eta", &loaded.eta}, {"beta", &loaded.beta}, {"gamma", &loaded.gamma}
+    };
+
+    for(const auto& [key, value] : fields) {
+        if(!entry.contains(key))
+            continue;
+        if(!entry[key].is_number())
+            return false;
+        *value = entry[key].get<double>();
+    }
+
+    params = loaded;
+    return true;
+}
+
+// replaces the instrument's entry and keeps the others, written atomically
+inline bool save_impact_params(const std::string& path, const std::string& instrument, const impact_params& params, const impact_fit& fit) {
+    nlohmann::json file = read_impact_file(path);
+
+    file[instrument] = {
+        {"alpha", params.alpha}, {"eta", params.eta}, {"beta", params.beta}, {"gamma", params.gamma},
+        {"samples", fit.samples}, {"permanent_samples", fit.permanent_samples}, {"temporary_r2", fit.temporary_r2()}, {"permanent_r2", fit.permanent_r2()}
+    };
+
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp);
+        if(!(out << file.dump(4) << '\n'))
+            return false;
+    }
+
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
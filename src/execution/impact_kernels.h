@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+// impact model eta * v^alpha + gamma * v^beta of the base quantity v
+struct impact_params {
+    double alpha, eta, beta, gamma;
+};
+
+// Exponents with a cheaper form than pow() get their own policy, the kernel is instantiated
+// per pair of policies so the exponentiation is resolved at compile time
+// Constant exponents pick the kernel directly, impact_kernel<exponent_kind_of(alpha), ...>,
+// runtime ones go through dispatch_impact_kernel once per batch
+enum class exponent_kind {
+    one,       // v
+    half,      // sqrt(v)
+    point_six, // exp(0.6 log v), no closed form in sqrt and multiplies but skips pow's special cases
+    runtime    // pow(v, exponent)
+};
+
+constexpr exponent_kind exponent_kind_of(double exponent) {
+    // the GUI constants are floats, 0.6f is not 0.6
+    return exponent == 1 ? exponent_kind::one
+        : exponent == 0.5 ? exponent_kind::half
+        : exponent == 0.6 || exponent == static_cast<double>(0.6f) ? exponent_kind::point_six
+        : exponent_kind::runtime;
+}
+
+template<exponent_kind Kind>
+struct exponent_policy {
+    explicit exponent_policy(double exponent): m_exponent{exponent} {}
+    double operator()(double v) const { return std::pow(v, m_exponent); }
+private:
+    double m_exponent;
+};
+
+template<>
+struct exponent_policy<exponent_kind::one> {
+    explicit constexpr exponent_policy(double) {}
+    constexpr double operator()(double v) const { return v; }
+};
+
+template<>
+struct exponent_policy<exponent_kind::half> {
+    explicit constexpr exponent_policy(double) {}
+    double operator()(double v) const { return std::sqrt(v); }
+};
+
+template<>
+struct exponent_policy<exponent_kind::point_six> {
+    explicit constexpr exponent_policy(double) {}
+    double operator()(double v) const { return std::exp(0.6 * std::log(v)); }
+};
+
+template<exponent_kind Temporary, exponent_kind Permanent>
+class impact_kernel {
+public:
+    explicit impact_kernel(const impact_params& params)
+        : m_eta{params.eta}, m_gamma{params.gamma}, m_temporary{params.alpha}, m_permanent{params.beta} {}
+
+    double temporary(double volume) const { return m_eta * m_temporary(volume); }
+    double permanent(double volume) const { return m_gamma * m_permanent(volume); }
+
+    double operator()(double volume) const { return temporary(volume) + permanent(volume); }
+
+    // out[i] = impact of volumes[i], a branch free loop the compiler can vectorize
+    void evaluate(const double* volumes, double* out, size_t n) const {
+        for(size_t i = 0; i < n; i++)
+            out[i] = temporary(volumes[i]) + permanent(volumes[i]);
+    }
+private:
+    double m_eta;
+    double m_gamma;
+    exponent_policy<Temporary> m_temporary;
+    exponent_policy<Permanent> m_permanent;
+};
+
+namespace impact_kernel_detail {
+    template<exponent_kind Temporary, class F>
+    decltype(auto) dispatch_permanent(const impact_params& params, F&& f) {
+        switch(exponent_kind_of(params.beta)) {
+            case exponent_kind::one: return f(impact_kernel<Temporary, exponent_kind::one>{params});
+            case exponent_kind::half: return f(impact_kernel<Temporary, exponent_kind::half>{params});
+            case exponent_kind::point_six: return f(impact_kernel<Temporary, exponent_kind::point_six>{params});
+            default: return f(impact_kernel<Temporary, exponent_kind::runtime>{params});
+        }
+    }
+}
+
+// calls f with the kernel specialized for the runtime exponents, e.g.
+// dispatch_impact_kernel(params, [&](const auto& kernel) { kernel.evaluate(volumes, out, n); });
+template<class F>
+decltype(auto) dispatch_impact_kernel(const impact_params& params, F&& f) {
+    using namespace impact_kernel_detail;
+
+    switch(exponent_kind_of(params.alpha)) {
+        case exponent_kind::one: return dispatch_permanent<exponent_kind::one>(params, f);
+        case exponent_kind::half: return dispatch_permanent<exponent_kind::half>(params, f);
+        case exponent_kind::point_six: return dispatch_permanent<exponent_kind::point_six>(params, f);
+        default: return dispatch_permanent<exponent_kind::runtime>(params, f);
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include <book/order_book.h>
+#include <lib/utilities.h>
+
+constexpr size_t MAKER_TAKER_FEATURES = 3;
+
+// same features, order and names as src/models/utils.py (MAKER_TAKER_FEATURES)
+constexpr const char* MAKER_TAKER_FEATURE_NAMES[MAKER_TAKER_FEATURES] = {"spread_bps", "imbalance", "log_size_ratio"};
+
+// book depth summed into the imbalance
+constexpr size_t MAKER_TAKER_IMBALANCE_DEPTH = 5;
+
+// Expected maker share of a buy worked at the touch before crossing, logistic regression over
+// book features trained by src/models/train_maker_taker.py
+// Without a loaded parameter file the whole order is assumed to take liquidity
+class maker_taker_model {
+public:
+    // parameter file written by train_maker_taker.py, false keeps the previous model
+    bool load(const std::string& path) {
+        std::ifstream in(path);
+        if(!in) {
+            APP_LOG(log_flags::client_trader, "No maker/taker model at " << path << ", fees assume taker only");
+            return false;
+        }
+
+        nlohmann::json params = nlohmann::json::parse(in, nullptr, false);
+
+        // every key an array of one entry per feature, of strings for the names and numbers otherwise
+        auto is_feature_array = [&](const char* key, bool numbers) {
+            if(!params.contains(key) || !params[key].is_array() || params[key].size() != MAKER_TAKER_FEATURES)
+                return false;
+            return std::all_of(params[key].begin(), params[key].end(), [&](const nlohmann::json& value) {
+                return numbers ? value.is_number() : value.is_string();
+            });
+        };
+
+        if(!params.is_object() || !is_feature_array("features", false) || !is_feature_array("mean", true) || !is_feature_array("scale", true)
+                || !is_feature_array("coef", true) || !params.contains("intercept") || !params["intercept"].is_number()) {
+            APP_LOG(log_flags::client_trader, "Invalid maker/taker model " << path);
+            return false;
+        }
+
+        for(size_t i = 0; i < MAKER_TAKER_FEATURES; i++) {
+            if(params["features"][i] != MAKER_TAKER_FEATURE_NAMES[i]) {
+                APP_LOG(log_flags::client_trader, "Maker/taker model " << path << " expects feature " << params["features"][i]
+                    << ", built for " << MAKER_TAKER_FEATURE_NAMES[i]);
+                return false;
+            }
+
+            // the features are divided by it
+            if(params["scale"][i].get<double>() == 0) {
+                APP_LOG(log_flags::client_trader, "Maker/taker model " << path << " has a zero scale for " << MAKER_TAKER_FEATURE_NAMES[i]);
+                return false;
+            }
+        }
+
+        for(size_t i = 0; i < MAKER_TAKER_FEATURES; i++) {
+            m_mean[i] = params["mean"][i].get<double>();
+            m_scale[i] = params["scale"][i].get<double>();
+            m_coef[i] = params["coef"][i].get<double>();
+        }
+        m_intercept = params["intercept"].get<double>();
+        m_loaded = true;
+
+        APP_LOG(log_flags::client_trader, "Loaded maker/taker model " << path);
+        return true;
+    }
+
+    void unload() { m_loaded = false; }
+
+    bool loaded() const { return m_loaded; }
+
+    // expected maker share in [0, 1] of a buy of order_usd
+    double maker_proportion(const order_book& book, double order_usd) const {
+        if(!m_loaded || !book.valid())
+            return 0;
+
+        double features[MAKER_TAKER_FEATURES];
+        extract_features(book, order_usd, features);
+
+        double z = m_intercept;
+        for(size_t i = 0; i < MAKER_TAKER_FEATURES; i++)
+            z += m_coef[i] * (features[i] - m_mean[i]) / m_scale[i];
+
+        return 1 / (1 + std::exp(-z));
+    }
+
+    static void extract_features(const order_book& book, double order_usd, double (&features)[MAKER_TAKER_FEATURES]) {
+        double best_ask = book.best_ask(), best_bid = book.best_bid();
+        double mid = (best_ask + best_bid) / 2;
+
+        double depth_ask = 0, depth_bid = 0;
+        for(size_t i = 0; i < MAKER_TAKER_IMBALANCE_DEPTH && i < book.asks.size(); i++)
+            depth_ask += book.asks[i].size;
+        for(size_t i = 0; i < MAKER_TAKER_IMBALANCE_DEPTH && i < book.bids.size(); i++)
+            depth_bid += book.bids[i].size;
+
+        features[0] = (best_ask - best_bid) / mid * 1e4;
+        features[1] = (depth_bid - depth_ask) / (depth_bid + depth_ask + 1e-6);
+        features[2] = std::log1p(order_usd / mid / book.asks[0].size);
+    }
+private:
+    bool m_loaded = false;
+
+    double m_mean[MAKER_TAKER_FEATURES] {};
+    double m_scale[MAKER_TAKER_FEATURES] {};
+    double m_coef[MAKER_TAKER_FEATURES] {};
+    double m_intercept = 0;
+};
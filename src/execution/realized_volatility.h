@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// horizon of the volatility inputs (InputWindowState::volatility_pct), one day
+constexpr double VOLATILITY_HORIZON_S = 86400;
+
+struct volatility_options {
+    double halflife_s = 300;     // EWMA half life
+    double window_s = 900;       // rolling window
+    double sample_interval_s = 1; // minimum time between two returns, damps bid/ask bounce of the mid
+};
+
+// Realized volatility of the mid price, updated per book in O(1)
+// Log returns are taken at most once per sample interval and turned into a variance rate per
+// second two ways: an exponentially time decayed sum of squared returns over the decayed
+// elapsed time, and the plain sum over a rolling time window (ring buffer, amortized O(1))
+class realized_volatility {
+public:
+    realized_volatility(volatility_options options = {})
+        : m_options{options}, m_samples(ROLLING_INITIAL_CAPACITY) {}
+
+    void update(int64_t ts_ns, double mid) {
+        if(mid <= 0)
+            return;
+
+        if(m_last_ns == 0) {
+            m_last_ns = ts_ns;
+            m_last_mid = mid;
+            return;
+        }
+
+        double dt = (ts_ns - m_last_ns) / 1e9;
+        if(dt < m_options.sample_interval_s)
+            return;
+
+        double r = std::log(mid / m_last_mid);
+        double r2 = r * r;
+
+        // EWMA, the decay follows elapsed time rather than the number of books
+        double decay = std::exp2(-dt / m_options.halflife_s);
+        m_ewma_r2 = decay * m_ewma_r2 + r2;
+        m_ewma_dt = decay * m_ewma_dt + dt;
+
+        // rolling window
+        push(ts_ns, r2, dt);
+        int64_t cutoff = ts_ns - static_cast<int64_t>(m_options.window_s * 1e9);
+        while(m_count > 0 && m_samples[m_head].ts_ns <= cutoff)
+            pop();
+
+        m_last_ns = ts_ns;
+        m_last_mid = mid;
+        m_returns++;
+    }
+
+    void reset() {
+        m_last_ns = 0;
+        m_ewma_r2 = m_ewma_dt = 0;
+        m_head = m_count = 0;
+        m_rolling_r2 = m_rolling_dt = 0;
+        m_returns = 0;
+    }
+
+    // returns seen since the start, estimates are noisy for the first few
+    uint64_t returns() const { return m_returns; }
+
+    // volatility over the horizon in percent, 0 before the first return
+    double ewma_pct(double horizon_s = VOLATILITY_HORIZON_S) const { return to_pct(m_ewma_r2, m_ewma_dt, horizon_s); }
+    double rolling_pct(double horizon_s = VOLATILITY_HORIZON_S) const { return to_pct(m_rolling_r2, m_rolling_dt, horizon_s); }
+private:
+    static constexpr size_t ROLLING_INITIAL_CAPACITY = 1024;
+
+    struct sample {
+        int64_t ts_ns;
+        double r2;
+        double dt;
+    };
+
+    static double to_pct(double r2, double dt, double horizon_s) {
+        return dt > 0 ? std::sqrt(r2 / dt * horizon_s) * 100 : 0;
+    }
+
+    void push(int64_t ts_ns, double r2, double dt) {
+        if(m_count == m_samples.size())
+            grow();
+
+        m_samples[(m_head + m_count) % m_samples.size()] = {ts_ns, r2, dt};
+        m_count++;
+
+        m_rolling_r2 += r2;
+        m_rolling_dt += dt;
+    }
+
+    void pop() {
+        const sample& oldest = m_samples[m_head];
+        m_rolling_r2 -= oldest.r2;
+        m_rolling_dt -= oldest.dt;
+
+        m_head = (m_head + 1) % m_samples.size();
+        m_count--;
+
+        // the running sums drift by rounding, restart them whenever the window empties
+        if(m_count == 0)
+            m_rolling_r2 = m_rolling_dt = 0;
+    }
+
+    // doubles the ring, only while the window fills up for the first time
+    void grow() {
+        std::vector<sample> samples(m_samples.size() * 2);
+        for(size_t i = 0; i < m_count; i++)
+            samples[i] = m_samples[(m_head + i) % m_samples.size()];
+
+        m_samples.swap(samples);
+        m_head = 0;
+    }
+
+    volatility_options m_options;
+
+    int64_t m_last_ns = 0;
+    double m_last_mid = 0;
+    uint64_t m_returns = 0;
+
+    double m_ewma_r2 = 0;
+    double m_ewma_dt = 0;
+
+    std::vector<sample> m_samples;
+    size_t m_head = 0;
+    size_t m_count = 0;
+    double m_rolling_r2 = 0;
+    double m_rolling_dt = 0;
+};
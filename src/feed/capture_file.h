@@ -0,0 +1,50 @@
+#pragma once
+
+#include <deque>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Feed captures written with CLIENT_TRADER_RECORD_FILE, one message per line (see
+// websocket/feed_recorder.h), read whole for the offline tools
+class capture_file {
+public:
+    // appends the file's messages to the capture, false if it cannot be read
+    bool read(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if(!in)
+            return false;
+
+        // a day of books is a few GB, read it in one go
+        std::string& data = m_files.emplace_back();
+        in.seekg(0, std::ios::end);
+        data.resize(static_cast<size_t>(in.tellg()));
+        in.seekg(0, std::ios::beg);
+
+        if(!in.read(data.data(), data.size())) {
+            m_files.pop_back();
+            return false;
+        }
+
+        std::string_view text = data;
+        for(size_t begin = 0; begin < text.size();) {
+            size_t end = text.find('\n', begin);
+            if(end == std::string_view::npos)
+                end = text.size();
+
+            if(end > begin)
+                m_messages.push_back(text.substr(begin, end - begin));
+            begin = end + 1;
+        }
+
+        return true;
+    }
+
+    // messages of every file read, in order; valid while the capture lives
+    const std::vector<std::string_view>& messages() const { return m_messages; }
+private:
+    // a deque never moves its elements, so the views stay valid as files are added
+    std::deque<std::string> m_files;
+    std::vector<std::string_view> m_messages;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <book/order_book.h>
+
+// Venue specific part of the L2 pipeline: where to connect and how to read the messages
+// Everything downstream of parse() works on the normalized order_book
+class feed_adapter {
+public:
+    virtual ~feed_adapter() = default;
+
+    // name shown in the GUI and used as the connection key, e.g. "OKX"
+    virtual const char* exchange() const = 0;
+
+    virtual const char* default_base_url() const = 0;
+
+    // websocket url streaming the instrument's book, e.g. BTC -> <base_url>BTC-USDT-SWAP
+    virtual std::string endpoint_url(const std::string& base_url, const std::string& instrument) const = 0;
+
+    // fills book from one message, false if the message is not a valid snapshot
+    virtual bool parse(std::string_view payload, order_book& book) const = 0;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include <feed/feed_adapter.h>
+#include <feed/okx_adapter.h>
+#include <feed/synthetic_adapter.h>
+
+// All supported venues, in the order shown in the GUI
+inline const std::vector<std::unique_ptr<feed_adapter>>& feed_adapters() {
+    static const std::vector<std::unique_ptr<feed_adapter>> adapters = [] {
+        std::vector<std::unique_ptr<feed_adapter>> list;
+        list.push_back(std::make_unique<okx_adapter>());
+        list.push_back(std::make_unique<synthetic_adapter>());
+        return list;
+    }();
+
+    return adapters;
+}
+
+// nullptr for an unknown exchange
+inline const feed_adapter* find_feed_adapter(std::string_view exchange) {
+    for(const auto& adapter : feed_adapters())
+        if(exchange == adapter->exchange())
+            return adapter.get();
+
+    return nullptr;
+}
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+
+#include <book/order_book.h>
+#include <feed/l2_simd.h>
+#include <lib/timestamp.h>
+
+// Schema specialized streaming parser for flat L2 snapshot messages:
+// {"<time>": ..., "<symbol>": "...", "<asks>": [[p, s], ...], "<bids>": [[p, s], ...], <other keys>}
+// A single pass over the payload writes the levels straight into the book, there is no DOM and
+// nothing is allocated once the book's vectors have grown to the feed's depth
+// Prices and sizes may be numbers or decimal strings, unknown keys are skipped
+
+enum class l2_timestamp_format {
+    iso, // "2025-05-18T05:00:10.123Z"
+    ns   // integer nanoseconds since epoch
+};
+
+struct l2_schema {
+    std::string_view asks_key;
+    std::string_view bids_key;
+    std::string_view symbol_key;
+    std::string_view timestamp_key;
+    l2_timestamp_format timestamp_format;
+};
+
+class l2_parser {
+public:
+    // fills book from payload, false if it is not a valid snapshot
+    // book.exchange is left to the caller
+    static bool parse(std::string_view payload, const l2_schema& schema, order_book& book) {
+        l2_parser parser {payload};
+
+        book.clear();
+        bool has_asks = false, has_bids = false;
+
+        if(!parser.consume('{'))
+            return false;
+
+        if(parser.consume('}'))
+            return false;
+
+        do {
+            std::string_view key;
+            if(!parser.read_string(key) || !parser.consume(':'))
+                return false;
+
+            bool ok;
+            if(key == schema.asks_key) {
+                ok = parser.read_levels(book.asks);
+                has_asks = true;
+            } else if(key == schema.bids_key) {
+                ok = parser.read_levels(book.bids);
+                has_bids = true;
+            } else if(key == schema.symbol_key) {
+                std::string_view symbol;
+                ok = parser.read_string(symbol);
+                book.symbol.assign(symbol.data(), symbol.size());
+            } else if(key == schema.timestamp_key) {
+                ok = parser.read_timestamp(schema.timestamp_format, book.exchange_ts_ns);
+            } else {
+                ok = parser.skip_value();
+            }
+
+            if(!ok)
+                return false;
+        } while(parser.consume(','));
+
+        if(!parser.consume('}') || !has_asks || !has_bids)
+            return false;
+
+        book.normalize();
+        return true;
+    }
+private:
+    l2_parser(std::string_view text): m_pos{text.data()}, m_end{text.data() + text.size()} {}
+
+    void skip_whitespace() {
+        while(m_pos < m_end && (*m_pos == ' ' || *m_pos == '\n' || *m_pos == '\r' || *m_pos == '\t'))
+            m_pos++;
+    }
+
+    // skips whitespace, then takes c if it is next
+    bool consume(char c) {
+        skip_whitespace();
+
+        if(m_pos < m_end && *m_pos == c) {
+            m_pos++;
+            return true;
+        }
+
+        return false;
+    }
+
+    // raw contents between the quotes, escapes are not decoded (none occur in the schema's keys)
+    bool read_string(std::string_view& out) {
+        if(!consume('"'))
+            return false;
+
+        const char* start = m_pos;
+        m_pos = l2_simd::find_quote_or_escape(m_pos, m_end);
+
+        while(m_pos < m_end && *m_pos == '\\') {
+            // skip the escaped character
+            if(m_end - m_pos < 2)
+                return false;
+            m_pos = l2_simd::find_quote_or_escape(m_pos + 2, m_end);
+        }
+
+        if(m_pos >= m_end)
+            return false;
+
+        out = std::string_view(start, m_pos - start);
+        m_pos++;
+        return true;
+    }
+
+    // number or quoted decimal string
+    bool read_number(double& out) {
+        skip_whitespace();
+
+        bool quoted = m_pos < m_end && *m_pos == '"';
+        if(quoted)
+            m_pos++;
+
+        // plain decimals take the fast path, exponents and long mantissas the general one
+        const char* number_end = l2_simd::find_number_end(m_pos, m_end);
+        bool exponent = number_end < m_end && (*number_end == 'e' || *number_end == 'E');
+
+        if(!exponent && l2_simd::parse_decimal(m_pos, number_end, m_end, out)) {
+            m_pos = number_end;
+        } else {
+            auto result = std::from_chars(m_pos, m_end, out);
+            if(result.ec != std::errc())
+                return false;
+            m_pos = result.ptr;
+        }
+
+        return !quoted || consume('"');
+    }
+
+    // [[price, size], ...], appended to out
+    bool read_levels(std::vector<book_level>& out) {
+        if(!consume('['))
+            return false;
+
+        if(consume(']'))
+            return true;
+
+        do {
+            book_level level;
+
+            if(!read_compact_level(level)) {
+                if(!consume('[') || !read_number(level.price) || !consume(',') || !read_number(level.size))
+                    return false;
+
+                // venues may append fields to a level, e.g. order counts
+                while(consume(','))
+                    if(!skip_value())
+                        return false;
+
+                if(!consume(']'))
+                    return false;
+            }
+
+            out.push_back(level);
+        } while(consume(','));
+
+        return consume(']');
+    }
+
+    // [p,s] or ["p","s"] without whitespace, plain decimals only; false leaves the position
+    // unchanged for the general path (whitespace, extra fields, exponents)
+    bool read_compact_level(book_level& level) {
+        const char* p = m_pos;
+
+        if(p >= m_end || *p != '[')
+            return false;
+        p++;
+
+        if(!read_compact_number(p, level.price) || p >= m_end || *p != ',')
+            return false;
+        p++;
+
+        if(!read_compact_number(p, level.size) || p >= m_end || *p != ']')
+            return false;
+
+        m_pos = p + 1;
+        return true;
+    }
+
+    bool read_compact_number(const char*& p, double& out) const {
+        bool quoted = p < m_end && *p == '"';
+        p += quoted;
+
+        const char* number_end = l2_simd::find_number_end(p, m_end);
+        if(number_end == p || !l2_simd::parse_decimal(p, number_end, m_end, out))
+            return false;
+
+        p = number_end;
+
+        if(quoted) {
+            if(p >= m_end || *p != '"')
+                return false;
+            p++;
+        }
+
+        return true;
+    }
+
+    bool read_timestamp(l2_timestamp_format format, int64_t& out_ns) {
+        if(format == l2_timestamp_format::iso) {
+            std::string_view text;
+            return read_string(text) && parse_iso_timestamp_ns(text, out_ns);
+        }
+
+        skip_whitespace();
+        auto result = std::from_chars(m_pos, m_end, out_ns);
+        if(result.ec != std::errc())
+            return false;
+
+        m_pos = result.ptr;
+        return true;
+    }
+
+    // skips any value, nested containers included
+    bool skip_value() {
+        skip_whitespace();
+        if(m_pos >= m_end)
+            return false;
+
+        if(*m_pos == '"') {
+            std::string_view ignored;
+            return read_string(ignored);
+        }
+
+        if(*m_pos == '[' || *m_pos == '{') {
+            char close = *m_pos == '[' ? ']' : '}';
+            m_pos++;
+
+            if(consume(close))
+                return true;
+
+            do {
+                if(close == '}') {
+                    std::string_view ignored;
+                    if(!read_string(ignored) || !consume(':'))
+                        return false;
+                }
+
+                if(!skip_value())
+                    return false;
+            } while(consume(','));
+
+            return consume(close);
+        }
+
+        // number or literal
+        const char* start = m_pos;
+        while(m_pos < m_end && *m_pos != ',' && *m_pos != ']' && *m_pos != '}'
+                && *m_pos != ' ' && *m_pos != '\n' && *m_pos != '\r' && *m_pos != '\t')
+            m_pos++;
+
+        return m_pos > start;
+    }
+
+    const char* m_pos;
+    const char* m_end;
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Vectorized scanning for the L2 parser: the level arrays are almost entirely short decimal
+// tokens, so the parser's cost is finding where each one ends and converting it
+// AVX2 is used when compiled in (-DENABLE_AVX2=ON), SSE2 on any x86-64, a scalar loop otherwise
+namespace l2_simd {
+
+#if defined(__AVX2__)
+constexpr const char* INSTRUCTION_SET = "AVX2";
+#elif defined(__SSE2__)
+constexpr const char* INSTRUCTION_SET = "SSE2";
+#else
+constexpr const char* INSTRUCTION_SET = "scalar";
+#endif
+
+inline bool is_number_char(char c) {
+    return (c >= '0' && c <= '9') || c == '.';
+}
+
+// first byte in [p, end) that is neither a digit nor '.', end if there is none
+inline const char* find_number_end(const char* p, const char* end) {
+#if defined(__AVX2__)
+    const __m256i below_zero = _mm256_set1_epi8('0' - 1);
+    const __m256i above_nine = _mm256_set1_epi8('9' + 1);
+    const __m256i dot = _mm256_set1_epi8('.');
+
+    for(; p + 32 <= end; p += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+
+        // signed compares, bytes >= 0x80 are negative and never digits
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(chunk, below_zero), _mm256_cmpgt_epi8(above_nine, chunk));
+        __m256i number = _mm256_or_si256(digit, _mm256_cmpeq_epi8(chunk, dot));
+
+        uint32_t other = ~static_cast<uint32_t>(_mm256_movemask_epi8(number));
+        if(other != 0)
+            return p + __builtin_ctz(other);
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128i below_zero_16 = _mm_set1_epi8('0' - 1);
+    const __m128i above_nine_16 = _mm_set1_epi8('9' + 1);
+    const __m128i dot_16 = _mm_set1_epi8('.');
+
+    for(; p + 16 <= end; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chunk, below_zero_16), _mm_cmplt_epi8(chunk, above_nine_16));
+        __m128i number = _mm_or_si128(digit, _mm_cmpeq_epi8(chunk, dot_16));
+
+        uint32_t other = ~static_cast<uint32_t>(_mm_movemask_epi8(number)) & 0xFFFF;
+        if(other != 0)
+            return p + __builtin_ctz(other);
+    }
+#endif
+
+    // scalar fallback and the tail of the buffer
+    while(p < end && is_number_char(*p))
+        p++;
+
+    return p;
+}
+
+// first '"' or '\\' in [p, end), end if there is none
+inline const char* find_quote_or_escape(const char* p, const char* end) {
+#if defined(__AVX2__)
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i escape = _mm256_set1_epi8('\\');
+
+    for(; p + 32 <= end; p += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i found = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, escape));
+
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(found));
+        if(mask != 0)
+            return p + __builtin_ctz(mask);
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128i quote_16 = _mm_set1_epi8('"');
+    const __m128i escape_16 = _mm_set1_epi8('\\');
+
+    for(; p + 16 <= end; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i found = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote_16), _mm_cmpeq_epi8(chunk, escape_16));
+
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(found));
+        if(mask != 0)
+            return p + __builtin_ctz(mask);
+    }
+#endif
+
+    while(p < end && *p != '"' && *p != '\\')
+        p++;
+
+    return p;
+}
+
+// exact powers of ten as doubles
+constexpr double POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+constexpr uint64_t POW10_INT[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+};
+
+// bytes the word at a time conversion may read from the start of a number
+constexpr size_t DECIMAL_READ_AHEAD = 24;
+
+// first n bytes of a little endian word, n <= 8
+inline uint64_t low_bytes(size_t n) {
+    return n >= 8 ? ~0ull : (1ull << (8 * n)) - 1;
+}
+
+// 0x80 in every byte of word equal to c, exact (no false positives above a match)
+inline uint64_t bytes_equal(uint64_t word, char c) {
+    uint64_t x = word ^ (0x0101010101010101ull * static_cast<unsigned char>(c));
+    return ~(((x & 0x7F7F7F7F7F7F7F7Full) + 0x7F7F7F7F7F7F7F7Full) | x | 0x7F7F7F7F7F7F7F7Full);
+}
+
+// value of the n <= 8 digits at p, 8 bytes must be readable from p
+// The digits are moved to the top of the word so the bytes after them drop out, then combined
+// pairwise in three multiplications (Lemire, "Fast number parsing")
+inline uint32_t parse_digits(const char* p, size_t n) {
+    if(n == 0)
+        return 0;
+
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+
+    // a borrow from a byte past the digits only reaches the bytes above it, which are shifted out
+    word -= 0x3030303030303030ull;
+    word <<= 8 * (8 - n);
+
+    word = word * 10 + (word >> 8);
+    word = (((word & 0x000000FF000000FFull) * (100 + (1000000ull << 32)))
+        + (((word >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+    return static_cast<uint32_t>(word);
+}
+
+// converts a plain decimal such as 103259.9, false if it needs the general conversion
+// The mantissa and the power of ten are both exact doubles, so the single division is
+// correctly rounded and matches std::from_chars (Clinger's fast path)
+// [begin, end) holds only digits and dots (find_number_end); with DECIMAL_READ_AHEAD bytes
+// readable before readable_end, the integer and fraction parts of up to 8 digits each are
+// converted a word at a time instead of digit by digit
+inline bool parse_decimal(const char* begin, const char* end, const char* readable_end, double& out) {
+    size_t length = end - begin;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if(length > 0 && length <= 16 && readable_end - begin >= static_cast<ptrdiff_t>(DECIMAL_READ_AHEAD)) {
+        uint64_t low, high;
+        std::memcpy(&low, begin, sizeof(low));
+        std::memcpy(&high, begin + 8, sizeof(high));
+
+        uint64_t low_dots = bytes_equal(low, '.') & low_bytes(length);
+        uint64_t high_dots = length > 8 ? bytes_equal(high, '.') & low_bytes(length - 8) : 0;
+
+        // at most one dot (popcount is a libgcc call without -mpopcnt)
+        bool one_dot = (low_dots | high_dots) != 0;
+        bool more_dots = (low_dots & (low_dots - 1)) != 0 || (high_dots & (high_dots - 1)) != 0 || (low_dots != 0 && high_dots != 0);
+
+        size_t integer = low_dots != 0 ? __builtin_ctzll(low_dots) / 8 : high_dots != 0 ? 8 + __builtin_ctzll(high_dots) / 8 : length;
+        size_t fraction = one_dot ? length - integer - 1 : 0;
+
+        if(!more_dots && integer <= 8 && fraction <= 8 && integer + fraction > 0 && integer + fraction <= 15) {
+            uint64_t mantissa = parse_digits(begin, integer) * POW10_INT[fraction] + parse_digits(begin + integer + 1, fraction);
+            out = static_cast<double>(mantissa) / POW10[fraction];
+            return true;
+        }
+    }
+#else
+    (void) readable_end;
+#endif
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    const char* dot = nullptr;
+
+    for(const char* p = begin; p < end; p++) {
+        if(*p == '.') {
+            if(dot != nullptr)
+                return false;
+            dot = p;
+            continue;
+        }
+
+        mantissa = mantissa * 10 + (*p - '0');
+        digits++;
+    }
+
+    int fraction = dot != nullptr ? end - dot - 1 : 0;
+
+    if(digits == 0 || digits > 15 || fraction > 22)
+        return false;
+
+    out = static_cast<double>(mantissa) / POW10[fraction];
+    return true;
+}
+
+}
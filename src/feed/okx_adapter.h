@@ -0,0 +1,29 @@
+#pragma once
+
+#include <feed/feed_adapter.h>
+#include <feed/l2_parser.h>
+#include <lib/config.h>
+
+// OKX USDT-SWAP books as relayed by the GoQuant endpoint:
+// {"timestamp": "2025-05-18T05:00:10Z", "exchange": "OKX", "symbol": "BTC-USDT-SWAP",
+//  "asks": [["103260", "601.05"], ...], "bids": [["103259.9", "0.83"], ...]}
+class okx_adapter : public feed_adapter {
+public:
+    const char* exchange() const override { return "OKX"; }
+
+    const char* default_base_url() const override { return OKX_WS_BASE_URL; }
+
+    std::string endpoint_url(const std::string& base_url, const std::string& instrument) const override {
+        return base_url + instrument + "-USDT-SWAP";
+    }
+
+    bool parse(std::string_view payload, order_book& book) const override {
+        constexpr l2_schema schema {"asks", "bids", "symbol", "timestamp", l2_timestamp_format::iso};
+
+        if(!l2_parser::parse(payload, schema, book))
+            return false;
+
+        book.exchange = exchange();
+        return true;
+    }
+};
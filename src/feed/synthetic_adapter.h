@@ -0,0 +1,30 @@
+#pragma once
+
+#include <feed/feed_adapter.h>
+#include <feed/l2_parser.h>
+
+#define SYNTHETIC_WS_BASE_URL "ws://127.0.0.1:8080/ws/l2-orderbook/synthetic/"
+
+// Compact numeric format served by the local replay server (--format synthetic), used to
+// exercise a second venue without the network:
+// {"ts": 1747544410000000000, "sym": "BTC-USDT-SWAP", "a": [[103260.0, 601.05], ...], "b": [...]}
+class synthetic_adapter : public feed_adapter {
+public:
+    const char* exchange() const override { return "Synthetic"; }
+
+    const char* default_base_url() const override { return SYNTHETIC_WS_BASE_URL; }
+
+    std::string endpoint_url(const std::string& base_url, const std::string& instrument) const override {
+        return base_url + instrument + "-USDT-SWAP";
+    }
+
+    bool parse(std::string_view payload, order_book& book) const override {
+        constexpr l2_schema schema {"a", "b", "sym", "ts", l2_timestamp_format::ns};
+
+        if(!l2_parser::parse(payload, schema, book))
+            return false;
+
+        book.exchange = exchange();
+        return true;
+    }
+};
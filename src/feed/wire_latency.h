@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+#include <book/order_book.h>
+#include <lib/latency.h>
+#include <websocket/feed_subscriber.h>
+
+// Exchange to client latency of a feed, from the exchange time the feed adapter parsed into the
+// book (order_book::exchange_ts_ns) to the local receive time of its message
+// Kept on the consumer side so the transport stays venue independent; only the books the
+// consumer reads are sampled
+// Venues truncate their timestamps (the OKX relay sends whole seconds), which spreads the raw
+// difference uniformly over [latency, latency + tick). The tick is detected from the timestamps
+// and every sample is corrected by half of it, so the p50 tracks the actual latency; the spread
+// of the distribution stays about one tick wide
+class wire_latency {
+public:
+    // false if the venue sent no timestamp
+    bool record(const order_book& book, const message_timestamps& timestamps) {
+        if(book.exchange_ts_ns <= 0)
+            return false;
+
+        // the finest tick seen so far, a millisecond feed is also divisible by 1 s now and then
+        int64_t tick = timestamp_tick(book.exchange_ts_ns);
+        if(m_resolution_ns == 0 || tick < m_resolution_ns)
+            m_resolution_ns = tick;
+
+        // kernel arrival when available
+        int64_t receive_ns = timestamps.kernel_ns != 0 ? timestamps.kernel_ns : timestamps.callback_ns;
+        m_latency.record(receive_ns - book.exchange_ts_ns - m_resolution_ns / 2);
+        return true;
+    }
+
+    latency_summary summary() const { return m_latency.summary(); }
+
+    // tick of the exchange timestamps, 0 before the first sample
+    int64_t resolution_ns() const { return m_resolution_ns; }
+private:
+    static constexpr int64_t MAX_TICK_NS = 1000000000;
+
+    // largest power of ten up to a second dividing the timestamp
+    static int64_t timestamp_tick(int64_t ts_ns) {
+        int64_t tick = 1;
+        while(tick < MAX_TICK_NS && ts_ns % (tick * 10) == 0)
+            tick *= 10;
+        return tick;
+    }
+
+    rolling_latency m_latency;
+    int64_t m_resolution_ns = 0;
+};
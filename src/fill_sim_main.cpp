@@ -0,0 +1,196 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <algorithm>
+#include <chrono>
+
+#include <execution/fill_simulator.h>
+#include <feed/capture_file.h>
+#include <feed/feed_registry.h>
+#include <lib/worker_pool.h>
+#include <lib/utilities.h>
+
+std::chrono::time_point<std::chrono::high_resolution_clock> g_timer_start;
+
+// Places hypothetical limit orders into recorded books (captures from CLIENT_TRADER_RECORD_FILE)
+// and reports how often and how fast they fill
+// The capture is split into one contiguous range of messages per thread: each thread places
+// the orders of its range and keeps reading past its end until they are done, so the result
+// does not depend on the thread count
+struct fill_sim_options {
+    std::vector<std::string> captures;
+    std::string exchange = "OKX";
+    std::string symbol = "BTC";  // prefix of the book's symbol
+    order_side side = order_side::buy;
+    size_t level = 0;            // joins the n-th level of its side, 0 is the touch
+    double qty = 0.01;           // base units
+    size_t every = 10;           // one order every n messages
+    double ttl_s = 60;
+    queue_model queue = queue_model::pro_rata;
+    size_t threads = 0;
+};
+
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [options] <capture.jsonl>...\n"
+        << "  --exchange <OKX|Synthetic>     message format of the capture (default OKX)\n"
+        << "  --symbol <prefix>              books simulated, by symbol prefix (default BTC)\n"
+        << "  --side <buy|sell>              order side (default buy)\n"
+        << "  --level <n>                    price level joined, 0 is the best price (default 0)\n"
+        << "  --qty <base>                   order quantity (default 0.01)\n"
+        << "  --every <n>                    one order every n messages (default 10)\n"
+        << "  --ttl <s>                      order lifetime in exchange time (default 60)\n"
+        << "  --queue <pro-rata|front>       meaning of level decreases (default pro-rata)\n"
+        << "  --threads <n>                  0 uses every core (default 0)\n";
+}
+
+double percentile(std::vector<double>& values, double q) {
+    if(values.empty())
+        return 0;
+
+    size_t k = std::min(values.size() - 1, static_cast<size_t>(q * values.size()));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+int main(int argc, char** argv) {
+    // start global timer
+    g_timer_start = std::chrono::high_resolution_clock::now();
+
+    fill_sim_options options;
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if(arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        }
+
+        if(arg.rfind("--", 0) != 0) {
+            options.captures.push_back(arg);
+            continue;
+        }
+
+        if(i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << '\n';
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        std::string value = argv[++i];
+
+        if(arg == "--exchange") options.exchange = value;
+        else if(arg == "--symbol") options.symbol = value;
+        else if(arg == "--side" && value == "buy") options.side = order_side::buy;
+        else if(arg == "--side" && value == "sell") options.side = order_side::sell;
+        else if(arg == "--level") options.level = std::stoul(value);
+        else if(arg == "--qty") options.qty = std::stod(value);
+        else if(arg == "--every") options.every = std::max(1ul, std::stoul(value));
+        else if(arg == "--ttl") options.ttl_s = std::stod(value);
+        else if(arg == "--queue" && value == "pro-rata") options.queue = queue_model::pro_rata;
+        else if(arg == "--queue" && value == "front") options.queue = queue_model::front;
+        else if(arg == "--threads") options.threads = std::stoul(value);
+        else {
+            std::cerr << "Unknown option " << arg << '\n';
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(options.captures.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const feed_adapter* adapter = find_feed_adapter(options.exchange);
+    if(adapter == nullptr) {
+        std::cerr << "Unknown exchange " << options.exchange << '\n';
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // captures in the given order
+    capture_file capture;
+    for(const auto& path : options.captures) {
+        if(!capture.read(path)) {
+            std::cerr << "Cannot read " << path << '\n';
+            return 1;
+        }
+    }
+
+    const auto& messages = capture.messages();
+
+    const int64_t ttl_ns = static_cast<int64_t>(options.ttl_s * 1e9);
+
+    worker_pool pool {options.threads};
+    std::vector<std::vector<fill_record>> results(pool.size());
+    std::vector<size_t> books(pool.size());
+
+    pool.parallel_for(messages.size(), [&](size_t begin, size_t end, size_t chunk) {
+        fill_simulator simulator {options.queue};
+        order_book book;
+
+        for(size_t i = begin; i < messages.size(); i++) {
+            bool placing = i < end;
+            if(!placing && simulator.active() == 0)
+                break;
+
+            if(!adapter->parse(messages[i], book) || !book.valid() || book.symbol.rfind(options.symbol, 0) != 0)
+                continue;
+
+            if(placing)
+                books[chunk]++;
+            simulator.update(book);
+
+            const auto& levels = options.side == order_side::buy ? book.bids : book.asks;
+            if(placing && i % options.every == 0 && options.level < levels.size())
+                simulator.place(book, {options.side, levels[options.level].price, options.qty, ttl_ns});
+        }
+
+        simulator.finish();
+        results[chunk] = simulator.completed();
+    });
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t orders = 0, complete = 0, touched = 0, parsed = 0;
+    double filled_fraction = 0;
+    std::vector<double> first_fill_s, complete_s;
+
+    for(size_t chunk = 0; chunk < results.size(); chunk++) {
+        parsed += books[chunk];
+
+        for(const auto& record : results[chunk]) {
+            orders++;
+            filled_fraction += record.filled / record.order.qty;
+
+            if(record.first_fill_ns >= 0) {
+                touched++;
+                first_fill_s.push_back((record.first_fill_ns - record.placed_ns) / 1e9);
+            }
+            if(record.complete()) {
+                complete++;
+                complete_s.push_back((record.complete_ns - record.placed_ns) / 1e9);
+            }
+        }
+    }
+
+    if(orders == 0) {
+        std::cerr << "No orders placed, no " << options.symbol << " books in the captures?\n";
+        return 1;
+    }
+
+    std::cout << options.symbol << " " << (options.side == order_side::buy ? "buy" : "sell") << " " << options.qty
+        << " at level " << options.level << ", ttl " << options.ttl_s << " s, "
+        << (options.queue == queue_model::front ? "front" : "pro-rata") << " queue\n"
+        << "  books:      " << parsed << " in " << elapsed << " s (" << (parsed / elapsed) << " books/s, " << pool.size() << " threads)\n"
+        << "  orders:     " << orders << '\n'
+        << "  filled:     " << (100.0 * complete / orders) << "% complete, " << (100.0 * touched / orders) << "% at least partly, "
+            << (100.0 * filled_fraction / orders) << "% of the quantity\n"
+        << "  first fill: p50 " << percentile(first_fill_s, 0.5) << " s, p90 " << percentile(first_fill_s, 0.9) << " s\n"
+        << "  complete:   p50 " << percentile(complete_s, 0.5) << " s, p90 " << percentile(complete_s, 0.9) << " s\n";
+
+    return 0;
+}
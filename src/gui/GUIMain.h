@@ -11,6 +11,12 @@
 #include <GLFW/glfw3.h>
 
 #include <gui/GUIState.h>
+#include <book/book_features.h>
+#include <websocket/feed_metrics.h>
+#include <execution/cost_surface.h>
+#include <feed/feed_registry.h>
+#include <lib/dependency_graph.h>
+#include <lib/latency.h>
 
 constexpr float INPUT_PANEL_X = 300;
 constexpr float INPUT_PANEL_Y = 200;
@@ -21,6 +27,33 @@ constexpr float OUTPUT_PANEL_Y = 200;
 constexpr float PANEL_WIDTH = 600;
 constexpr float PANEL_HEIGHT = 350;
 
+constexpr float FEED_PANEL_X = 300;
+constexpr float FEED_PANEL_Y = 600;
+constexpr float FEED_PANEL_WIDTH = 1400;
+constexpr float FEED_PANEL_HEIGHT = 300;
+constexpr float FEED_PLOT_HEIGHT = 80;
+
+constexpr float AC_PLOT_HEIGHT = 60;
+
+constexpr float SURFACE_PANEL_X = 300;
+constexpr float SURFACE_PANEL_Y = 910;
+constexpr float SURFACE_PANEL_WIDTH = 1400;
+constexpr float SURFACE_PANEL_HEIGHT = 160;
+constexpr float SURFACE_TABLE_WIDTH = 700;
+
+constexpr float CALC_PANEL_X = 1710;
+constexpr float CALC_PANEL_Y = 200;
+constexpr float CALC_PANEL_WIDTH = 400;
+constexpr float CALC_PANEL_HEIGHT = 350;
+
+constexpr float FEATURE_PANEL_X = 1710;
+constexpr float FEATURE_PANEL_Y = 560;
+constexpr float FEATURE_PANEL_WIDTH = 400;
+constexpr float FEATURE_PANEL_HEIGHT = 350;
+
+// order sizes shown in the cost surface table, USD
+constexpr double SURFACE_TABLE_SIZES[] = {100, 1000, 10000, 100000, 1000000};
+
 extern InputWindowState g_input_window_state;
 extern float g_curr_time;
 extern float g_last_time;
@@ -30,6 +63,17 @@ extern float g_fps;
 class GUIMain {
 private:
     GLFWwindow* m_window;
+
+    std::vector<float> m_surface_bps; // plot buffer of the cost surface window
+
+    // grid index of the size closest to size_usd on a log scale
+    static size_t nearest_size(const cost_surface& surface, double size_usd) {
+        size_t best = 0;
+        for (size_t i = 1; i < surface.sizes(); i++)
+            if (std::abs(std::log(surface.size_usd(i) / size_usd)) < std::abs(std::log(surface.size_usd(best) / size_usd)))
+                best = i;
+        return best;
+    }
 public:
     GUIMain() {
         m_window = create_window();
@@ -48,11 +92,21 @@ public:
         g_fps = 1 / g_tick_latency;
     }
 
+    // name of the feed adapter picked in the input panel
+    const char* selected_exchange() const {
+        return feed_adapters()[g_input_window_state.selected_exchange]->exchange();
+    }
+
     void fill_input_data_gui(InputData& input_data) {
+        input_data.exchange = selected_exchange();
         input_data.instrument = g_input_window_state.instrument;
         input_data.order_sz = g_input_window_state.order_sz;
         input_data.fee_pct = g_input_window_state.fee_pct[g_input_window_state.selected_tier];
+        input_data.maker_fee_pct = g_input_window_state.maker_fee_pct[g_input_window_state.selected_tier];
         input_data.volatility_pct = g_input_window_state.volatility_pct;
+        input_data.live_volatility = g_input_window_state.live_volatility;
+        input_data.risk_aversion = g_input_window_state.risk_aversion;
+        input_data.ac_intervals = g_input_window_state.ac_intervals;
     }
 
     void init_imgui() {
@@ -89,12 +143,32 @@ public:
 
         ImGui::Begin("Input Panel");
         
-        ImGui::Text("Exchange: %s", g_input_window_state.exchange[0]);
+        // one entry per registered feed adapter
+        if (ImGui::BeginCombo("Exchange", selected_exchange()))
+        {
+            const auto& adapters = feed_adapters();
+            for (int n = 0; n < static_cast<int>(adapters.size()); n++)
+            {
+                bool is_selected = (n == g_input_window_state.selected_exchange);
+                if (ImGui::Selectable(adapters[n]->exchange(), is_selected))
+                    g_input_window_state.selected_exchange = n;
+                if (is_selected)
+                    ImGui::SetItemDefaultFocus();
+            }
+            ImGui::EndCombo();
+        }
+
         ImGui::InputText("SPOT Instrument (USDT-SWAP)", &g_input_window_state.instrument);
         ImGui::Text("Order Type: %s", g_input_window_state.order_type);
         ImGui::Text("Quantity: %i", g_input_window_state.order_sz);
     
         ImGui::SliderFloat("Volatility (%)", &g_input_window_state.volatility_pct, 0.01, 3.00);
+        ImGui::Checkbox("Live volatility", &g_input_window_state.live_volatility);
+        ImGui::SameLine();
+        ImGui::Text("realized: EWMA %.3f%%, rolling %.3f%%", g_input_window_state.realized_volatility_ewma,
+            g_input_window_state.realized_volatility_rolling);
+        ImGui::SliderFloat("Risk Aversion", &g_input_window_state.risk_aversion, 1e-9, 1e-2, "%.1e", ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderInt("Execution Intervals", &g_input_window_state.ac_intervals, 1, 1000);
         
         static const char* current_item = g_input_window_state.tiers[g_input_window_state.selected_tier];
         if (ImGui::BeginCombo("Fee Tier", current_item))
@@ -145,14 +219,23 @@ public:
         ImGui::SetNextWindowSize(ImVec2(PANEL_WIDTH, PANEL_HEIGHT));
         ImGui::Begin("Output Panel");
 
-        ImGui::Text("Selected %s for %iUSD quantity", input_data.instrument.c_str(), input_data.order_sz);
+        ImGui::Text("Selected %s %s for %iUSD quantity", input_data.exchange.c_str(), input_data.instrument.c_str(), input_data.order_sz);
         ImGui::Dummy(ImVec2(0.0f, 20.0f));
         
         ImGui::Text("Mid Price : %f", output_data.mid_price);
         ImGui::Text("Slippage (USD): %f", output_data.slippage);
         ImGui::Text("Market Impact (USD): %f", output_data.market_impact);
         ImGui::Text("Fees (USD): %f", output_data.fees);
+        ImGui::Text("Maker / Taker: %.1f%% / %.1f%%", output_data.maker_proportion * 100, (1 - output_data.maker_proportion) * 100);
         ImGui::Text("Net Cost (USD): %f", output_data.net_cost);
+
+        ImGui::Text("Optimal Execution Cost (USD): %f +- %f", output_data.ac_expected_cost, output_data.ac_cost_std);
+        if (!output_data.ac_holdings.empty())
+            ImGui::PlotLines("##ac_holdings", output_data.ac_holdings.data(), output_data.ac_holdings.size(), 0,
+                "remaining order", 0.0f, 1.0f, ImVec2(ImGui::GetContentRegionAvail().x, AC_PLOT_HEIGHT));
+        if (output_data.mc_paths > 0)
+            ImGui::Text("Simulated Cost (USD): mean %f, VaR95 %f, ES95 %f (%zu paths, %.1fms)", output_data.mc_mean,
+                output_data.mc_var, output_data.mc_expected_shortfall, output_data.mc_paths, output_data.mc_time_ms);
         
         ImGui::Dummy(ImVec2(0.0f, 20.0f));
         ImGui::Text("Tick Latency (s): %f", g_tick_latency);
@@ -160,6 +243,190 @@ public:
 
         ImGui::End();
     }
+
+    void imgui_feed_window(const feed_stats& stats, const latency_breakdown& latency, float wire_latency_alert_ms) {
+        using histogram = log2_histogram<FEED_HISTOGRAM_BUCKETS>;
+
+        ImGui::SetNextWindowPos(ImVec2(FEED_PANEL_X, FEED_PANEL_Y), ImGuiCond_Once);
+        ImGui::SetNextWindowSize(ImVec2(FEED_PANEL_WIDTH, FEED_PANEL_HEIGHT));
+        ImGui::Begin("Feed Panel");
+
+        ImGui::Text("Messages: %llu (%llu bytes), dropped by consumers: %llu",
+            (unsigned long long) stats.messages, (unsigned long long) stats.bytes, (unsigned long long) stats.dropped);
+        ImGui::Text("Rate: %.1f msg/s, %.1f KiB/s", stats.msgs_per_sec, stats.bytes_per_sec / 1024);
+        ImGui::Text("Since last message (ms): %.1f", stats.since_last_msg_ms);
+
+        const latency_summary& wire = latency.wire;
+        bool latency_alert = wire.count > 0 && wire.p99_ms > wire_latency_alert_ms;
+        if (latency_alert)
+            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.8f, 0.1f, 0.1f, 1.0f));
+
+        ImGui::Text("Wire latency (ms): last %.1f, p50 %.1f, p99 %.1f, max %.1f (%zu samples)",
+            wire.last_ms, wire.p50_ms, wire.p99_ms, wire.max_ms, wire.count);
+
+        // coarse exchange timestamps spread the samples over a tick, corrected by half of it
+        if (latency.wire_resolution_ms > 0)
+            ImGui::Text("Exchange timestamp resolution: %.3g ms, +/- %.3g ms per sample",
+                latency.wire_resolution_ms, latency.wire_resolution_ms / 2);
+
+        if (latency_alert)
+            ImGui::PopStyleColor();
+
+        if (latency.kernel_to_callback.count > 0) {
+            const latency_summary& kernel = latency.kernel_to_callback;
+            ImGui::Text("Kernel -> callback (ms): p50 %.3f, p99 %.3f, max %.3f",
+                kernel.p50_ms, kernel.p99_ms, kernel.max_ms);
+        }
+
+        const latency_summary& compute = latency.callback_to_compute;
+        ImGui::Text("Callback -> compute (ms): p50 %.3f, p99 %.3f, max %.3f",
+            compute.p50_ms, compute.p99_ms, compute.max_ms);
+
+        // log2 buckets, bucket i covers [2^(i-1), 2^i)
+        float inter_arrival[FEED_HISTOGRAM_BUCKETS];
+        float msg_size[FEED_HISTOGRAM_BUCKETS];
+        for (size_t i = 0; i < FEED_HISTOGRAM_BUCKETS; i++) {
+            inter_arrival[i] = stats.inter_arrival_us[i];
+            msg_size[i] = stats.msg_size_bytes[i];
+        }
+
+        float plot_width = ImGui::GetContentRegionAvail().x / 2 - ImGui::GetStyle().ItemSpacing.x;
+
+        std::string inter_arrival_label = "p50 < " + std::to_string(histogram::quantile(stats.inter_arrival_us, 0.5))
+            + "us, p99 < " + std::to_string(histogram::quantile(stats.inter_arrival_us, 0.99)) + "us";
+        std::string msg_size_label = "p50 < " + std::to_string(histogram::quantile(stats.msg_size_bytes, 0.5))
+            + "B, p99 < " + std::to_string(histogram::quantile(stats.msg_size_bytes, 0.99)) + "B";
+
+        ImGui::BeginGroup();
+        ImGui::Text("Inter-arrival time (log2 us)");
+        ImGui::PlotHistogram("##inter_arrival", inter_arrival, FEED_HISTOGRAM_BUCKETS, 0, inter_arrival_label.c_str(),
+            0, FLT_MAX, ImVec2(plot_width, FEED_PLOT_HEIGHT));
+        ImGui::EndGroup();
+
+        ImGui::SameLine();
+
+        ImGui::BeginGroup();
+        ImGui::Text("Message size (log2 bytes)");
+        ImGui::PlotHistogram("##msg_size", msg_size, FEED_HISTOGRAM_BUCKETS, 0, msg_size_label.c_str(),
+            0, FLT_MAX, ImVec2(plot_width, FEED_PLOT_HEIGHT));
+        ImGui::EndGroup();
+
+        ImGui::End();
+    }
+
+    void imgui_calculation_window(const dependency_graph& graph) {
+        ImGui::SetNextWindowPos(ImVec2(CALC_PANEL_X, CALC_PANEL_Y), ImGuiCond_Once);
+        ImGui::SetNextWindowSize(ImVec2(CALC_PANEL_WIDTH, CALC_PANEL_HEIGHT), ImGuiCond_Once);
+        ImGui::Begin("Calculations");
+
+        // runs and compute time of every node, skipped means its inputs did not change
+        if (ImGui::BeginTable("##calc_nodes", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit)) {
+            ImGui::TableSetupColumn("Node");
+            ImGui::TableSetupColumn("Runs");
+            ImGui::TableSetupColumn("Skipped");
+            ImGui::TableSetupColumn("Last (ms)");
+            ImGui::TableSetupColumn("p50 (ms)");
+            ImGui::TableHeadersRow();
+
+            for (const auto& node : graph.stats()) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", node.name->c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", (unsigned long long) node.runs);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", (unsigned long long) node.skips);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", node.time.last_ms);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", node.time.p50_ms);
+            }
+
+            ImGui::EndTable();
+        }
+
+        ImGui::End();
+    }
+
+    void imgui_book_features_window(const book_feature_engine& features) {
+        ImGui::SetNextWindowPos(ImVec2(FEATURE_PANEL_X, FEATURE_PANEL_Y), ImGuiCond_Once);
+        ImGui::SetNextWindowSize(ImVec2(FEATURE_PANEL_WIDTH, FEATURE_PANEL_HEIGHT), ImGuiCond_Once);
+        ImGui::Begin("Book Features");
+
+        if (features.updates() == 0) {
+            ImGui::Text("Waiting for the book");
+            ImGui::End();
+            return;
+        }
+
+        if (ImGui::BeginTable("##book_features", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit)) {
+            ImGui::TableSetupColumn("Feature");
+            ImGui::TableSetupColumn("Value");
+            ImGui::TableHeadersRow();
+
+            for (size_t i = 0; i < features.features().size(); i++) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", features.features()[i].name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.4f", features.values()[i]);
+            }
+
+            ImGui::EndTable();
+        }
+
+        ImGui::End();
+    }
+
+    void imgui_cost_surface_window(const cost_surface& surface, int selected_tier) {
+        ImGui::SetNextWindowPos(ImVec2(SURFACE_PANEL_X, SURFACE_PANEL_Y), ImGuiCond_Once);
+        ImGui::SetNextWindowSize(ImVec2(SURFACE_PANEL_WIDTH, SURFACE_PANEL_HEIGHT), ImGuiCond_Once);
+        ImGui::Begin("Cost Surface");
+
+        if (surface.mid_price() <= 0) {
+            ImGui::Text("Waiting for the book");
+            ImGui::End();
+            return;
+        }
+
+        // net cost (USD) of a few sizes for every tier
+        constexpr int columns = IM_ARRAYSIZE(SURFACE_TABLE_SIZES) + 1;
+        if (ImGui::BeginTable("##surface_table", columns, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit,
+                ImVec2(SURFACE_TABLE_WIDTH, 0))) {
+            ImGui::TableSetupColumn("Net cost (USD)");
+            for (double size_usd : SURFACE_TABLE_SIZES)
+                ImGui::TableSetupColumn(std::to_string((long long) size_usd).c_str());
+            ImGui::TableHeadersRow();
+
+            for (size_t tier = 0; tier < COST_SURFACE_TIERS; tier++) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", g_input_window_state.tiers[tier]);
+
+                for (double size_usd : SURFACE_TABLE_SIZES) {
+                    size_t i = nearest_size(surface, size_usd);
+                    ImGui::TableNextColumn();
+                    ImGui::Text(surface.exhausted(i) ? "%.2f*" : "%.2f", surface.at(i, tier).net_cost);
+                }
+            }
+
+            ImGui::EndTable();
+        }
+
+        ImGui::SameLine();
+
+        // net cost in bps of the order across the whole grid, selected tier
+        m_surface_bps.resize(surface.sizes());
+        for (size_t i = 0; i < surface.sizes(); i++)
+            m_surface_bps[i] = surface.at(i, selected_tier).net_cost / surface.size_usd(i) * 1e4;
+
+        std::string label = std::string(g_input_window_state.tiers[selected_tier]) + " net cost (bps), "
+            + std::to_string((long long) surface.size_usd(0)) + " to " + std::to_string((long long) surface.size_usd(surface.sizes() - 1)) + " USD";
+        ImGui::PlotLines("##surface_bps", m_surface_bps.data(), m_surface_bps.size(), 0, label.c_str(),
+            FLT_MAX, FLT_MAX, ImGui::GetContentRegionAvail());
+
+        ImGui::End();
+    }
     
     GLFWwindow* create_window() {
         // glfw: initialize and configure
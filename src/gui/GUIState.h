@@ -3,12 +3,16 @@
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
+#include <book/order_book.h>
+
 struct InputWindowState {
     // fixed values
     constexpr static std::array allowed_instruments = {"BTC", "ETH"}; // currently supported instruments
-    constexpr static float fee_pct[5] = { 0.5, 0.4, 0.3, 0.2, 0.1 };
+    constexpr static float fee_pct[5] = { 0.5, 0.4, 0.3, 0.2, 0.1 }; // taker
+    constexpr static float maker_fee_pct[5] = { 0.4, 0.32, 0.24, 0.16, 0.08 }; // 80% of taker, like OKX's regular tier
+
+    int selected_exchange = 0; // index in feed_adapters(), see feed/feed_registry.h
 
-    const char* exchange[1] = {"OKX"};
     const char* order_type = "Market";
     std::string instrument = "BTC";
     int order_sz = 100; // 100 USD equivalent
@@ -16,7 +20,16 @@ struct InputWindowState {
     const char* tiers[5] = { "Tier 1", "Tier 2", "Tier 3", "Tier 4", "Tier 5" };
     int selected_tier = 0; // 0 to 4
 
-    float volatility_pct = 0.1;
+    float volatility_pct = 0.1; // daily
+
+    // use the realized volatility of the feed (EWMA) instead of the slider
+    bool live_volatility = false;
+    float realized_volatility_ewma = 0;    // shown next to the slider, set by the main loop
+    float realized_volatility_rolling = 0;
+
+    // optimal execution schedule
+    float risk_aversion = 1e-6;
+    int ac_intervals = 100;
 
     std::string error_txt;
     bool update_btn_clicked = false;
@@ -29,26 +42,27 @@ struct InputWindowState {
 };
 
 struct InputData {
-    InputData() {
-        live_data["asks"] = json::array();
-        live_data["bids"] = json::array();
-    }
-
+    std::string exchange;
     std::string instrument;
     int order_sz;
     float fee_pct;
+    float maker_fee_pct;
     float volatility_pct;
+    bool live_volatility;
+    float risk_aversion;
+    int ac_intervals;
 
-    json live_data;
+    // latest normalized book of the selected exchange and instrument
+    order_book book;
 };
 
 std::ostream& operator<<(std::ostream& out, const InputData& input_data) {
-    out << input_data.instrument << "\n"
+    out << input_data.exchange << " " << input_data.instrument << "\n"
         << "Sz: " << input_data.order_sz << "\n"
         << "Fee Pct: " << input_data.fee_pct << "\n"
         << "Volatility Pct: " << input_data.volatility_pct << "\n"
-        << "asks: " << input_data.live_data["asks"].size() << "\n"
-        << "bids: " << input_data.live_data["bids"].size();
+        << "asks: " << input_data.book.asks.size() << "\n"
+        << "bids: " << input_data.book.bids.size();
 
     return out;
 }
@@ -59,14 +73,30 @@ struct OutputData {
     float fees = 0;
     float net_cost = 0;
 
+    float maker_proportion = 0; // expected maker share of the order, see execution/maker_taker_model.h
+
     float mid_price = 0;
+
+    // Almgren-Chriss optimal liquidation of order_sz
+    float ac_expected_cost = 0;
+    float ac_cost_std = 0;
+    std::vector<float> ac_holdings; // fraction of the order left after each interval
+
+    // simulated cost distribution of the schedule
+    float mc_mean = 0;
+    float mc_var = 0;
+    float mc_expected_shortfall = 0;
+    size_t mc_paths = 0;
+    float mc_time_ms = 0;
 };
 
 std::ostream& operator<<(std::ostream& out, const OutputData& output_data) {
     out << "Slippage Amount (USD): " << output_data.slippage << "\n"
         << "Market Impact (USD): " << output_data.market_impact << "\n"
-        << "Fees (USD): " << output_data.fees << "\n"
-        << "Net Cost (USD): " << output_data.net_cost;
+        << "Fees (USD): " << output_data.fees << " (maker " << output_data.maker_proportion << ")\n"
+        << "Net Cost (USD): " << output_data.net_cost << "\n"
+        << "AC Expected Cost (USD): " << output_data.ac_expected_cost << " +- " << output_data.ac_cost_std << "\n"
+        << "Simulated Cost (USD): mean " << output_data.mc_mean << " VaR95 " << output_data.mc_var << " ES95 " << output_data.mc_expected_shortfall;
 
     return out;
 }
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdlib>
+#include <string>
+
+#include <lib/thread_tuning.h>
+
+// production l2 orderbook feed
+#define OKX_WS_BASE_URL "wss://ws.gomarket-cpp.goquant.io/ws/l2-orderbook/okx/"
+
+// Runtime configuration, overridable through environment variables
+// e.g. CLIENT_TRADER_WS_URL=ws://127.0.0.1:8080/ws/l2-orderbook/okx/ ./client_trader
+struct app_config {
+    // base url overrides, empty keeps the feed adapter's default
+    std::string ws_base_url;           // OKX
+    std::string synthetic_ws_base_url; // Synthetic venue
+
+    // p99 exchange-to-client latency above which the feed panel flags the feed, above the 1 s
+    // resolution of the OKX timestamps, which alone spreads the samples by +/- 500 ms
+    float wire_latency_alert_ms = 1500;
+
+    // SO_TIMESTAMPNS kernel arrival times for websocket frames
+    bool kernel_timestamps = false;
+
+    // messages kept per connection for debugging
+    size_t message_history = 64;
+
+    // websocket I/O thread and the main (compute + render) thread
+    thread_tuning io_thread;
+    thread_tuning main_thread;
+
+    // SO_BUSY_POLL on the websocket sockets in microseconds, 0 disables
+    int busy_poll_us = 0;
+
+    // spin the I/O thread with poll() instead of blocking in run()
+    bool io_spin = false;
+
+    // conflation for the GUI book stream: 0 keeps only the latest update,
+    // otherwise at most one update per interval
+    int gui_throttle_ms = 0;
+
+    // capture file for every received message (JSON lines), empty disables recording
+    std::string record_file;
+
+    // python model server, see model_client/model_client.h
+    std::string model_host = "127.0.0.1";
+    int model_port = 9000;
+    int model_connections = 1;
+    int model_timeout_ms = 1000;
+
+    // cost surface over order sizes and fee tiers, 0 threads uses every core
+    int surface_sizes = 256;
+    int surface_threads = 0;
+
+    // directory of the <instrument>_maker_taker.json files from src/models/train_maker_taker.py
+    std::string maker_taker_dir = "src/models";
+
+    // per instrument eta and gamma written by calibrate_impact, the constants are used without it
+    std::string impact_params_file = "impact_params.json";
+
+    // realized volatility of the mid price, see execution/realized_volatility.h
+    int volatility_halflife_s = 300;
+    int volatility_window_s = 900;
+    int volatility_sample_ms = 1000;
+
+    // book features, see parse_book_features in book/book_features.h; empty keeps DEFAULT_BOOK_FEATURES
+    std::string book_features;
+
+    // Monte Carlo cost distribution of the execution schedule, rerun at most once per interval
+    int mc_paths = 100000;
+    int mc_interval_ms = 250;
+
+    static app_config from_env() {
+        app_config config;
+
+        if(const char* ws_base_url = std::getenv("CLIENT_TRADER_WS_URL"))
+            config.ws_base_url = ws_base_url;
+
+        if(const char* synthetic_ws_base_url = std::getenv("CLIENT_TRADER_SYNTHETIC_URL"))
+            config.synthetic_ws_base_url = synthetic_ws_base_url;
+
+        if(const char* alert_ms = std::getenv("CLIENT_TRADER_LATENCY_ALERT_MS"))
+            config.wire_latency_alert_ms = std::strtof(alert_ms, nullptr);
+
+        if(const char* kernel_timestamps = std::getenv("CLIENT_TRADER_KERNEL_TIMESTAMPS"))
+            config.kernel_timestamps = std::string(kernel_timestamps) == "1";
+
+        if(const char* message_history = std::getenv("CLIENT_TRADER_MESSAGE_HISTORY"))
+            config.message_history = std::strtoul(message_history, nullptr, 10);
+
+        auto env_int = [](const char* name, int& value) {
+            if(const char* text = std::getenv(name))
+                value = std::atoi(text);
+        };
+
+        env_int("CLIENT_TRADER_IO_CPU", config.io_thread.cpu);
+        env_int("CLIENT_TRADER_IO_PRIORITY", config.io_thread.fifo_priority);
+        env_int("CLIENT_TRADER_MAIN_CPU", config.main_thread.cpu);
+        env_int("CLIENT_TRADER_MAIN_PRIORITY", config.main_thread.fifo_priority);
+        env_int("CLIENT_TRADER_BUSY_POLL_US", config.busy_poll_us);
+        env_int("CLIENT_TRADER_GUI_THROTTLE_MS", config.gui_throttle_ms);
+        env_int("CLIENT_TRADER_MODEL_PORT", config.model_port);
+        env_int("CLIENT_TRADER_MODEL_CONNECTIONS", config.model_connections);
+        env_int("CLIENT_TRADER_MODEL_TIMEOUT_MS", config.model_timeout_ms);
+        env_int("CLIENT_TRADER_SURFACE_SIZES", config.surface_sizes);
+        env_int("CLIENT_TRADER_SURFACE_THREADS", config.surface_threads);
+        env_int("CLIENT_TRADER_VOL_HALFLIFE_S", config.volatility_halflife_s);
+        env_int("CLIENT_TRADER_VOL_WINDOW_S", config.volatility_window_s);
+        env_int("CLIENT_TRADER_VOL_SAMPLE_MS", config.volatility_sample_ms);
+        env_int("CLIENT_TRADER_MC_PATHS", config.mc_paths);
+        env_int("CLIENT_TRADER_MC_INTERVAL_MS", config.mc_interval_ms);
+
+        if(const char* model_host = std::getenv("CLIENT_TRADER_MODEL_HOST"))
+            config.model_host = model_host;
+
+        if(const char* maker_taker_dir = std::getenv("CLIENT_TRADER_MAKER_TAKER_DIR"))
+            config.maker_taker_dir = maker_taker_dir;
+
+        if(const char* impact_params_file = std::getenv("CLIENT_TRADER_IMPACT_PARAMS"))
+            config.impact_params_file = impact_params_file;
+
+        if(const char* book_features = std::getenv("CLIENT_TRADER_BOOK_FEATURES"))
+            config.book_features = book_features;
+
+        if(const char* record_file = std::getenv("CLIENT_TRADER_RECORD_FILE"))
+            config.record_file = record_file;
+
+        if(const char* io_spin = std::getenv("CLIENT_TRADER_IO_SPIN"))
+            config.io_spin = std::string(io_spin) == "1";
+
+        return config;
+    }
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <lib/latency.h>
+
+// Incremental recomputation with dirty flags
+// Sources are values set from outside (a new book, an edited input), nodes are computations
+// over other nodes. run() recomputes only the dirty nodes, in the order they were added, which
+// is a topological order since inputs must exist before their dependents. A node's compute
+// returns whether its output changed; only then are its dependents marked dirty
+class dependency_graph {
+public:
+    using node_id = size_t;
+
+    struct node_stats {
+        const std::string* name;
+        uint64_t runs;
+        uint64_t skips; // runs of the graph that did not need the node
+        latency_summary time;
+    };
+
+    node_id add_source(std::string name) {
+        return add(std::move(name), nullptr, {});
+    }
+
+    // compute may call retry() to run again on the next run(), e.g. after a failure
+    node_id add_node(std::string name, std::function<bool()> compute, const std::vector<node_id>& inputs) {
+        return add(std::move(name), std::move(compute), inputs);
+    }
+
+    void invalidate(node_id id) { m_nodes[id].dirty = true; }
+
+    // from a compute: the node stays dirty
+    void retry() { m_retry = true; }
+
+    bool dirty(node_id id) const { return m_nodes[id].dirty; }
+
+    // recomputes the dirty nodes, true if any ran
+    bool run() {
+        bool ran = false;
+
+        for(node_id id = 0; id < m_nodes.size(); id++) {
+            node& n = m_nodes[id];
+
+            if(!n.dirty) {
+                n.skips++;
+                continue;
+            }
+
+            bool changed = true;
+
+            if(n.compute) {
+                m_retry = false;
+
+                auto start = std::chrono::steady_clock::now();
+                changed = n.compute();
+                n.time.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+                n.runs++;
+                ran = true;
+            }
+
+            n.dirty = n.compute && m_retry;
+
+            if(changed)
+                for(node_id dependent : n.dependents)
+                    m_nodes[dependent].dirty = true;
+        }
+
+        return ran;
+    }
+
+    // computed nodes only
+    std::vector<node_stats> stats() const {
+        std::vector<node_stats> result;
+        for(const auto& n : m_nodes)
+            if(n.compute)
+                result.push_back({&n.name, n.runs, n.skips, n.time.summary()});
+        return result;
+    }
+private:
+    struct node {
+        std::string name;
+        std::function<bool()> compute; // empty for sources
+        std::vector<node_id> dependents;
+        bool dirty = true;
+
+        uint64_t runs = 0;
+        uint64_t skips = 0;
+        rolling_latency time;
+    };
+
+    node_id add(std::string name, std::function<bool()> compute, const std::vector<node_id>& inputs) {
+        node_id id = m_nodes.size();
+
+        m_nodes.emplace_back();
+        m_nodes.back().name = std::move(name);
+        m_nodes.back().compute = std::move(compute);
+
+        for(node_id input : inputs)
+            m_nodes[input].dependents.push_back(id);
+
+        return id;
+    }
+
+    // rolling_latency holds a mutex, nodes cannot move
+    std::deque<node> m_nodes;
+    bool m_retry = false;
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// splitmix64 step, used to expand a seed into generator state
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256+ (Blackman & Vigna), a few cycles per draw and 256 bits of state, for simulations
+// where std::mt19937_64 is too slow; not for anything security related
+class xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    explicit xoshiro256(uint64_t seed = 0) { this->seed(seed); }
+
+    void seed(uint64_t seed) {
+        for(auto& word : m_state)
+            word = splitmix64(seed);
+    }
+
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return UINT64_MAX; }
+
+    uint64_t operator()() {
+        uint64_t result = m_state[0] + m_state[3];
+        uint64_t t = m_state[1] << 17;
+
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = rotl(m_state[3], 45);
+
+        return result;
+    }
+
+    // uniform in (0, 1), never 0 so it is safe under log()
+    double uniform() { return ((*this)() >> 11) * 0x1.0p-53 + 0x1.0p-54; }
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t m_state[4];
+};
+
+// Standard normal draws with the 128 layer ziggurat (Marsaglia & Tsang 2000): one 64 bit draw,
+// a compare and a multiply ~99% of the time. The layer index and the value come from disjoint
+// bits of the draw, which avoids the correlation of the original SHR3 based generator
+class normal_ziggurat {
+public:
+    normal_ziggurat() {
+        const double m = 2147483648.0; // 2^31
+        const double v = 9.91256303526217e-3;
+        double d = ZIGGURAT_R, t = d;
+        double q = v / std::exp(-0.5 * d * d);
+
+        m_k[0] = static_cast<uint32_t>((d / q) * m);
+        m_k[1] = 0;
+        m_w[0] = q / m;
+        m_w[LAYERS - 1] = d / m;
+        m_f[0] = 1;
+        m_f[LAYERS - 1] = std::exp(-0.5 * d * d);
+
+        for(int i = LAYERS - 2; i >= 1; i--) {
+            d = std::sqrt(-2 * std::log(v / d + std::exp(-0.5 * d * d)));
+            m_k[i + 1] = static_cast<uint32_t>((d / t) * m);
+            t = d;
+            m_f[i] = std::exp(-0.5 * d * d);
+            m_w[i] = d / m;
+        }
+    }
+
+    template<class Rng>
+    double operator()(Rng& rng) const {
+        uint64_t bits = rng();
+        int32_t value = static_cast<int32_t>(bits >> 32);
+        uint32_t layer = bits & (LAYERS - 1);
+
+        if(magnitude(value) < m_k[layer])
+            return value * m_w[layer];
+
+        return slow_path(rng, value, layer);
+    }
+private:
+    static constexpr int LAYERS = 128;
+    static constexpr double ZIGGURAT_R = 3.442619855899; // start of the tail
+
+    static uint32_t magnitude(int32_t value) {
+        return value < 0 ? 0u - static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+    }
+
+    template<class Rng>
+    double slow_path(Rng& rng, int32_t value, uint32_t layer) const {
+        while(true) {
+            double x = value * m_w[layer];
+
+            // base layer: sample the tail beyond r
+            if(layer == 0) {
+                double y;
+                do {
+                    x = -std::log(rng.uniform()) / ZIGGURAT_R;
+                    y = -std::log(rng.uniform());
+                } while(y + y < x * x);
+
+                return value > 0 ? ZIGGURAT_R + x : -ZIGGURAT_R - x;
+            }
+
+            // wedge between the layer's rectangle and the density
+            if(m_f[layer] + rng.uniform() * (m_f[layer - 1] - m_f[layer]) < std::exp(-0.5 * x * x))
+                return x;
+
+            uint64_t bits = rng();
+            value = static_cast<int32_t>(bits >> 32);
+            layer = bits & (LAYERS - 1);
+
+            if(magnitude(value) < m_k[layer])
+                return value * m_w[layer];
+        }
+    }
+
+    uint32_t m_k[LAYERS];
+    double m_w[LAYERS];
+    double m_f[LAYERS];
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+// Appends JSON tokens to a caller owned buffer, for hot paths that serialize the same shape
+// every time: once the buffer has grown, writing does not allocate
+
+constexpr int JSON_DOUBLE_PRECISION = 10; // significant digits, enough for tick sized prices
+
+inline void json_append_number(std::string& out, double value) {
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, JSON_DOUBLE_PRECISION);
+    out.append(buffer, result.ptr);
+}
+
+// shortest representation that reads back as the same float
+inline void json_append_number(std::string& out, float value) {
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+inline void json_append_number(std::string& out, int64_t value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+inline void json_append_number(std::string& out, int value) {
+    json_append_number(out, static_cast<int64_t>(value));
+}
+
+// quoted string, escaping quotes, backslashes and control characters
+inline void json_append_string(std::string& out, std::string_view value) {
+    out += '"';
+
+    for(char c : value) {
+        if(c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if(static_cast<unsigned char>(c) < 0x20) {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+            out += escape;
+        } else {
+            out += c;
+        }
+    }
+
+    out += '"';
+}
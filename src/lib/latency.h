@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+constexpr size_t LATENCY_WINDOW_SAMPLES = 1024;
+
+struct latency_summary {
+    size_t count = 0; // samples in the window
+    double last_ms = 0;
+    double min_ms = 0;
+    double p50_ms = 0;
+    double p90_ms = 0;
+    double p99_ms = 0;
+    double max_ms = 0;
+};
+
+inline std::ostream& operator<<(std::ostream& out, const latency_summary& summary) {
+    out << "n=" << summary.count << " last=" << summary.last_ms << "ms"
+        << " p50=" << summary.p50_ms << "ms p90=" << summary.p90_ms << "ms"
+        << " p99=" << summary.p99_ms << "ms max=" << summary.max_ms << "ms";
+
+    return out;
+}
+
+// stages of a book update: exchange -> local arrival -> on_message -> calculations done
+struct latency_breakdown {
+    latency_summary wire;
+    latency_summary kernel_to_callback; // empty unless kernel timestamps are enabled
+    latency_summary callback_to_compute;
+    double wire_resolution_ms = 0; // tick of the exchange timestamps, the wire samples are corrected by half of it
+};
+
+// Latency distribution over the most recent window of samples
+// record() is called from the producer thread, summary() from any thread
+class rolling_latency {
+public:
+    rolling_latency(size_t window = LATENCY_WINDOW_SAMPLES): m_samples(window) {}
+
+    void record(int64_t latency_ns) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_samples[m_next] = latency_ns;
+        m_next = (m_next + 1) % m_samples.size();
+        m_count = std::min(m_count + 1, m_samples.size());
+        m_last = latency_ns;
+    }
+
+    latency_summary summary() const {
+        std::vector<int64_t> sorted;
+        latency_summary result;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if(m_count == 0)
+                return result;
+
+            sorted.assign(m_samples.begin(), m_samples.begin() + m_count);
+            result.last_ms = m_last / 1e6;
+        }
+
+        std::sort(sorted.begin(), sorted.end());
+
+        auto at = [&](double q) { return sorted[std::min<size_t>(q * sorted.size(), sorted.size() - 1)] / 1e6; };
+
+        result.count = sorted.size();
+        result.min_ms = sorted.front() / 1e6;
+        result.p50_ms = at(0.5);
+        result.p90_ms = at(0.9);
+        result.p99_ms = at(0.99);
+        result.max_ms = sorted.back() / 1e6;
+
+        return result;
+    }
+private:
+    mutable std::mutex m_mutex;
+    std::vector<int64_t> m_samples;
+    size_t m_next = 0;
+    size_t m_count = 0;
+    int64_t m_last = 0;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cerrno>
+#include <cstring>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <lib/utilities.h>
+
+// Placement and scheduling of a latency sensitive thread
+struct thread_tuning {
+    int cpu = -1;          // core to pin to, -1 leaves placement to the scheduler
+    int fifo_priority = 0; // SCHED_FIFO priority (1-99), 0 keeps the default policy
+};
+
+#ifdef __linux__
+// affinity of the process at startup, before any thread was pinned
+inline const cpu_set_t g_initial_affinity = []() {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    sched_getaffinity(0, sizeof(cpus), &cpus);
+    return cpus;
+}();
+#endif
+
+// applies the tuning to the calling thread, failures are logged and ignored
+// New threads inherit the affinity and policy of their creator, so a default tuning does not
+// mean "unchanged": it restores the startup affinity and SCHED_OTHER. Every thread the client
+// spawns calls this first, a pinned or SCHED_FIFO main thread then does not leak its settings
+// SCHED_FIFO usually needs CAP_SYS_NICE or an rtprio limit
+inline void apply_thread_tuning(const thread_tuning& tuning, const char* thread_name) {
+#ifdef __linux__
+    if(tuning.cpu < 0) {
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(g_initial_affinity), &g_initial_affinity);
+        if(err != 0)
+            APP_LOG(log_flags::client_trader, "Failed to restore the affinity of " << thread_name << " thread: " << std::strerror(err));
+    } else {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(tuning.cpu, &cpus);
+
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if(err != 0)
+            APP_LOG(log_flags::client_trader, "Failed to pin " << thread_name << " thread to cpu " << tuning.cpu << ": " << std::strerror(err));
+        else
+            APP_LOG(log_flags::client_trader, "Pinned " << thread_name << " thread to cpu " << tuning.cpu);
+    }
+
+    if(tuning.fifo_priority <= 0) {
+        int policy;
+        sched_param param {};
+
+        if(pthread_getschedparam(pthread_self(), &policy, &param) == 0 && policy != SCHED_OTHER) {
+            param.sched_priority = 0;
+
+            int err = pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+            if(err != 0)
+                APP_LOG(log_flags::client_trader, "Failed to restore SCHED_OTHER on " << thread_name << " thread: " << std::strerror(err));
+        }
+    } else {
+        sched_param param {};
+        param.sched_priority = tuning.fifo_priority;
+
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if(err != 0)
+            APP_LOG(log_flags::client_trader, "Failed to set SCHED_FIFO " << tuning.fifo_priority << " on " << thread_name << " thread: " << std::strerror(err));
+        else
+            APP_LOG(log_flags::client_trader, "Running " << thread_name << " thread with SCHED_FIFO " << tuning.fifo_priority);
+    }
+#else
+    if(tuning.cpu >= 0 || tuning.fifo_priority > 0)
+        APP_LOG(log_flags::client_trader, "Thread tuning is only supported on linux");
+#endif
+}
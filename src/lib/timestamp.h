@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string_view>
+
+// ISO 8601 UTC timestamp with microseconds, e.g. 2025-05-18T05:00:10.123456Z
+constexpr std::size_t ISO_TIMESTAMP_US_LEN = 27;
+
+// writes exactly ISO_TIMESTAMP_US_LEN characters, no null terminator
+inline void format_iso_timestamp_us(char* out, std::chrono::system_clock::time_point tp) {
+    long long us = std::chrono::duration_cast<std::chrono::microseconds>(tp.time_since_epoch()).count();
+    std::time_t secs = us / 1000000;
+    int frac = us % 1000000;
+
+    std::tm tm;
+    gmtime_r(&secs, &tm);
+
+    char date[20];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", &tm);
+
+    for(int i = 0; i < 19; i++)
+        out[i] = date[i];
+
+    out[19] = '.';
+    for(int i = 25; i >= 20; i--) {
+        out[i] = '0' + frac % 10;
+        frac /= 10;
+    }
+    out[26] = 'Z';
+}
+
+// days since 1970-01-01 for a proleptic gregorian date (Howard Hinnant's days_from_civil)
+constexpr int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+// parses YYYY-MM-DDTHH:MM:SS[.fraction]Z into nanoseconds since epoch, false if malformed
+inline bool parse_iso_timestamp_ns(std::string_view text, int64_t& out_ns) {
+    auto digits = [&](size_t pos, size_t len, int64_t& value) {
+        if(pos + len > text.size())
+            return false;
+
+        value = 0;
+        for(size_t i = pos; i < pos + len; i++) {
+            if(text[i] < '0' || text[i] > '9')
+                return false;
+            value = value * 10 + (text[i] - '0');
+        }
+        return true;
+    };
+
+    int64_t year, month, day, hour, minute, second;
+    if(!digits(0, 4, year) || !digits(5, 2, month) || !digits(8, 2, day)
+            || !digits(11, 2, hour) || !digits(14, 2, minute) || !digits(17, 2, second))
+        return false;
+
+    if(text[4] != '-' || text[7] != '-' || text[10] != 'T' || text[13] != ':' || text[16] != ':')
+        return false;
+
+    // optional fraction, up to nanosecond precision
+    int64_t frac_ns = 0;
+    size_t pos = 19;
+    if(pos < text.size() && text[pos] == '.') {
+        int64_t scale = 100000000;
+        for(pos++; pos < text.size() && text[pos] >= '0' && text[pos] <= '9'; pos++) {
+            frac_ns += (text[pos] - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    if(pos >= text.size() || text[pos] != 'Z')
+        return false;
+
+    int64_t secs = days_from_civil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    out_ns = secs * 1000000000 + frac_ns;
+    return true;
+}
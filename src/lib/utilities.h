@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <iomanip>
 #include <chrono>
 
 extern std::chrono::time_point<std::chrono::high_resolution_clock> g_timer_start;
@@ -11,7 +12,8 @@ enum class log_flags {
     ws            = 1,
     client_trader = 2,
     trade_handler = 4,
-    benchmark     = 8
+    benchmark     = 8,
+    replay_server = 16
 };
 
 inline constexpr log_flags operator|(log_flags a, log_flags b) {
@@ -23,7 +25,7 @@ inline constexpr log_flags operator&(log_flags a, log_flags b) {
 }
 
 constexpr static log_flags ENABLED_LOG_FLAGS = (log_flags::ws 
-    | log_flags::client_trader | log_flags::trade_handler | log_flags::benchmark);
+    | log_flags::client_trader | log_flags::trade_handler | log_flags::benchmark | log_flags::replay_server);
 
 // Format
 // [<time>] <log type>: <msg>
@@ -36,6 +38,7 @@ constexpr static log_flags ENABLED_LOG_FLAGS = (log_flags::ws
         if(flag == log_flags::ws) std::clog << "websocket: "; \
         else if(flag == log_flags::client_trader) std::clog << "client: "; \
         else if(flag == log_flags::trade_handler) std::clog << "trade_handler: "; \
+        else if(flag == log_flags::replay_server) std::clog << "replay_server: "; \
         std::clog << message << std::endl; \
     } while(false)
 
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <lib/thread_tuning.h>
+
+// Persistent threads for data parallel loops on the compute path
+// parallel_for splits [0, n) into one contiguous chunk per thread, the calling thread runs
+// the first chunk itself and returns once every chunk is done
+// One parallel_for at a time: the pool belongs to a single caller thread
+class worker_pool {
+public:
+    // total threads including the caller, 0 uses every hardware thread
+    worker_pool(size_t threads = 0) {
+        if(threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        // workers do not keep the creator's pinning or real-time policy
+        for(size_t i = 1; i < threads; i++)
+            m_workers.emplace_back([this, i]() {
+                apply_thread_tuning({}, "worker");
+                run(i);
+            });
+    }
+
+    ~worker_pool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+
+        m_start.notify_all();
+        for(auto& worker : m_workers)
+            worker.join();
+    }
+
+    worker_pool(const worker_pool&) = delete;
+    worker_pool& operator=(const worker_pool&) = delete;
+
+    size_t size() const { return m_workers.size() + 1; }
+
+    // body(begin, end, chunk) for each chunk, chunk is the thread index in [0, size())
+    void parallel_for(size_t n, const std::function<void(size_t, size_t, size_t)>& body) {
+        size_t chunks = std::min(size(), n);
+        if(chunks <= 1) {
+            if(n > 0)
+                body(0, n, 0);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_body = &body;
+            m_n = n;
+            m_chunks = chunks;
+            m_pending = chunks - 1;
+            m_generation++;
+        }
+        m_start.notify_all();
+
+        auto [begin, end] = chunk_range(0);
+        body(begin, end, 0);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]() { return m_pending == 0; });
+        m_body = nullptr;
+    }
+private:
+    std::pair<size_t, size_t> chunk_range(size_t chunk) const {
+        return {m_n * chunk / m_chunks, m_n * (chunk + 1) / m_chunks};
+    }
+
+    void run(size_t index) {
+        size_t seen = 0;
+
+        while(true) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [&]() { return m_stopping || m_generation != seen; });
+
+            if(m_stopping)
+                return;
+
+            seen = m_generation;
+
+            // fewer chunks than threads for small loops
+            if(index >= m_chunks)
+                continue;
+
+            const auto* body = m_body;
+            auto [begin, end] = chunk_range(index);
+            lock.unlock();
+
+            (*body)(begin, end, index);
+
+            lock.lock();
+            if(--m_pending == 0)
+                m_done.notify_one();
+        }
+    }
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+
+    const std::function<void(size_t, size_t, size_t)>* m_body = nullptr;
+    size_t m_n = 0;
+    size_t m_chunks = 0;
+    size_t m_pending = 0;
+    size_t m_generation = 0;
+    bool m_stopping = false;
+};
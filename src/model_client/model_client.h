@@ -0,0 +1,368 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <lib/utilities.h>
+
+// every message, request or response, is a 4 byte big endian length followed by the JSON body
+constexpr size_t MODEL_FRAME_HEADER = 4;
+constexpr size_t MODEL_MAX_MESSAGE = 64 << 20; // same limit as the server, larger lengths are a desync
+
+struct model_client_options {
+    std::string host = "127.0.0.1";
+    int port = 9000;
+
+    // sockets in the pool, each carries one request at a time
+    size_t connections = 1;
+
+    // connect, send and receive timeout of a single request
+    std::chrono::milliseconds timeout {1000};
+
+    // minimum time between two connection attempts of the same socket while the server is down
+    std::chrono::milliseconds reconnect_interval {1000};
+};
+
+struct model_client_stats {
+    uint64_t requests = 0;
+    uint64_t failures = 0;
+    uint64_t connects = 0; // successful connects, reconnects included
+    size_t connected = 0;  // sockets currently connected
+};
+
+// Managed connection to the python model server (src/models/socket_server.py)
+// Sockets are connected on demand, checked before every request and reconnected after EOF,
+// errors or timeouts, so the server can be restarted under a running client
+// request() is thread safe: with several connections, that many requests run in parallel
+class model_client {
+public:
+    model_client(model_client_options options = {})
+        : m_options{std::move(options)}, m_connections(std::max<size_t>(1, m_options.connections)) {}
+
+    ~model_client() {
+        for(auto& con : m_connections)
+            if(con.fd >= 0)
+                ::close(con.fd);
+    }
+
+    model_client(const model_client&) = delete;
+    model_client& operator=(const model_client&) = delete;
+
+    // sends one request and reads the response into response (reused, overwritten)
+    // false if the server is unreachable or does not answer within the timeout
+    bool request(std::string_view payload, std::string& response) {
+        connection& con = acquire();
+
+        bool ok = false;
+
+        // a connection that was up may have been closed by a server restart since the health
+        // check, so a failure on it is retried once on a fresh connection
+        for(int attempt = 0; attempt < 2 && !ok; attempt++) {
+            bool was_connected = con.fd >= 0;
+
+            if(!ensure_connected(con))
+                break;
+
+            ok = exchange(con, payload, response);
+
+            if(!ok && !was_connected)
+                break;
+        }
+
+        release(con, ok);
+        return ok;
+    }
+
+    // round trip through the server's ping method
+    bool ping() {
+        std::string response;
+        return request("{\"method\":\"ping\",\"params\":{}}", response)
+            && response.find("pong") != std::string::npos;
+    }
+
+    model_client_stats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+private:
+    struct connection {
+        int fd = -1;
+        bool busy = false;
+        bool reported_down = false; // the failure was logged, log again once it recovers
+        std::chrono::steady_clock::time_point last_attempt {};
+    };
+
+    connection& acquire() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_available.wait(lock, [this]() {
+            for(const auto& con : m_connections)
+                if(!con.busy)
+                    return true;
+            return false;
+        });
+
+        // prefer a connected socket
+        connection* free = nullptr;
+        for(auto& con : m_connections) {
+            if(con.busy)
+                continue;
+            if(free == nullptr || (free->fd < 0 && con.fd >= 0))
+                free = &con;
+        }
+
+        free->busy = true;
+        m_stats.requests++;
+        return *free;
+    }
+
+    void release(connection& con, bool ok) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            con.busy = false;
+            m_stats.failures += !ok;
+        }
+
+        m_available.notify_one();
+    }
+
+    // health check, then a rate limited reconnect if the socket is down
+    bool ensure_connected(connection& con) {
+        if(con.fd >= 0) {
+            const char* problem = check_socket(con.fd);
+            if(problem == nullptr)
+                return true;
+
+            drop(con, problem);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if(now - con.last_attempt < m_options.reconnect_interval)
+            return false;
+
+        con.last_attempt = now;
+        return connect_socket(con);
+    }
+
+    // nullptr if an idle socket looks usable, otherwise why it is not
+    static const char* check_socket(int fd) {
+        char byte;
+        ssize_t n = recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+
+        if(n == 0)
+            return "closed by server";
+        if(n > 0)
+            return "unexpected data, stale response"; // would desync request and response
+        if(errno != EAGAIN && errno != EWOULDBLOCK)
+            return std::strerror(errno);
+
+        return nullptr;
+    }
+
+    bool connect_socket(connection& con) {
+        addrinfo hints {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+
+        addrinfo* addresses = nullptr;
+        std::string port = std::to_string(m_options.port);
+
+        if(getaddrinfo(m_options.host.c_str(), port.c_str(), &hints, &addresses) != 0 || addresses == nullptr) {
+            report_failure(con, "cannot resolve host");
+            return false;
+        }
+
+        int fd = socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+        if(fd < 0) {
+            freeaddrinfo(addresses);
+            report_failure(con, std::strerror(errno));
+            return false;
+        }
+
+        // non blocking connect, bounded by the request timeout
+        int flags = fcntl(fd, F_GETFL, 0);
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+        int result = ::connect(fd, addresses->ai_addr, addresses->ai_addrlen);
+        freeaddrinfo(addresses);
+
+        if(result < 0 && errno == EINPROGRESS) {
+            pollfd pfd {fd, POLLOUT, 0};
+            int ready = poll(&pfd, 1, m_options.timeout.count());
+
+            int error = ready == 0 ? ETIMEDOUT : ready < 0 ? errno : 0;
+            socklen_t len = sizeof(error);
+            if(ready == 1)
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len);
+
+            result = error == 0 ? 0 : -1;
+            errno = error;
+        }
+
+        if(result < 0) {
+            report_failure(con, std::strerror(errno));
+            ::close(fd);
+            return false;
+        }
+
+        fcntl(fd, F_SETFL, flags);
+
+        // small request/response messages: no Nagle delay, bounded blocking
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        timeval tv {};
+        tv.tv_sec = m_options.timeout.count() / 1000;
+        tv.tv_usec = (m_options.timeout.count() % 1000) * 1000;
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+        con.fd = fd;
+        con.reported_down = false;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.connects++;
+            m_stats.connected++;
+        }
+
+        APP_LOG(log_flags::client_trader, "Connected to model server " << m_options.host << ":" << m_options.port
+            << " (connection " << (&con - m_connections.data()) << ")");
+        return true;
+    }
+
+    // one framed request, one framed response read into response
+    bool exchange(connection& con, std::string_view payload, std::string& response) {
+        if(payload.size() > MODEL_MAX_MESSAGE) {
+            APP_LOG(log_flags::client_trader, "Model request of " << payload.size() << " bytes exceeds the " << MODEL_MAX_MESSAGE << " byte limit");
+            return false;
+        }
+
+        unsigned char header[MODEL_FRAME_HEADER];
+        encode_length(payload.size(), header);
+
+        // header and body in one segment
+        iovec iov[2] = {
+            {header, sizeof(header)},
+            {const_cast<char*>(payload.data()), payload.size()}
+        };
+
+        if(!send_all(con, iov, 2))
+            return false;
+
+        if(!recv_all(con, reinterpret_cast<char*>(header), sizeof(header)))
+            return false;
+
+        size_t length = decode_length(header);
+        if(length > MODEL_MAX_MESSAGE) {
+            drop(con, "invalid response length");
+            return false;
+        }
+
+        // keeps the capacity of earlier responses
+        response.resize(length);
+        return recv_all(con, response.data(), length);
+    }
+
+    bool send_all(connection& con, iovec* iov, int count) {
+        while(count > 0) {
+            msghdr msg {};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = count;
+
+            ssize_t n = sendmsg(con.fd, &msg, MSG_NOSIGNAL);
+            if(n <= 0) {
+                drop(con, n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) ? "send timed out" : "send failed");
+                return false;
+            }
+
+            // skip what was sent
+            size_t sent = n;
+            while(count > 0 && sent >= iov->iov_len) {
+                sent -= iov->iov_len;
+                iov++;
+                count--;
+            }
+
+            if(count > 0) {
+                iov->iov_base = static_cast<char*>(iov->iov_base) + sent;
+                iov->iov_len -= sent;
+            }
+        }
+
+        return true;
+    }
+
+    bool recv_all(connection& con, char* data, size_t size) {
+        for(size_t received = 0; received < size;) {
+            ssize_t n = recv(con.fd, data + received, size - received, 0);
+
+            if(n <= 0) {
+                drop(con, n == 0 ? "closed by server" : (errno == EAGAIN || errno == EWOULDBLOCK) ? "response timed out" : std::strerror(errno));
+                return false;
+            }
+
+            received += n;
+        }
+
+        return true;
+    }
+
+    static void encode_length(size_t length, unsigned char* header) {
+        for(size_t i = 0; i < MODEL_FRAME_HEADER; i++)
+            header[i] = static_cast<unsigned char>(length >> (8 * (MODEL_FRAME_HEADER - 1 - i)));
+    }
+
+    static size_t decode_length(const unsigned char* header) {
+        size_t length = 0;
+        for(size_t i = 0; i < MODEL_FRAME_HEADER; i++)
+            length = (length << 8) | header[i];
+        return length;
+    }
+
+    void drop(connection& con, const char* reason) {
+        APP_LOG(log_flags::client_trader, "Model server connection " << (&con - m_connections.data()) << " lost: " << reason);
+
+        ::close(con.fd);
+        con.fd = -1;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.connected--;
+    }
+
+    // logged once per outage, retries stay quiet until the connection recovers
+    void report_failure(connection& con, const char* reason) {
+        if(con.reported_down)
+            return;
+
+        con.reported_down = true;
+        APP_LOG(log_flags::client_trader, "Cannot connect to model server " << m_options.host << ":" << m_options.port
+            << ": " << reason << ", retrying every " << m_options.reconnect_interval.count() << "ms");
+    }
+
+    model_client_options m_options;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_available;
+    std::vector<connection> m_connections;
+
+    model_client_stats m_stats;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <book/book_writer.h>
+#include <lib/json_writer.h>
+
+constexpr size_t MODEL_REQUEST_RESERVE = 65536; // bytes, a 1000 level book per side fits
+
+// expected_slippage request for the model server, serialized straight from the native book
+// into a buffer owned by the caller and reused every frame:
+// {"method":"expected_slippage","params":{"instrument":"BTC","order_sz":100,"fee_pct":0.1,
+//  "volatility_pct":0.02,"asks":[[103260,601.05],...],"bids":[...]}}
+class slippage_request {
+public:
+    slippage_request(size_t reserve = MODEL_REQUEST_RESERVE) {
+        m_buffer.reserve(reserve);
+    }
+
+    const std::string& write(std::string_view instrument, int order_sz, float fee_pct, float volatility_pct, const order_book& book) {
+        m_buffer.clear();
+        m_buffer += "{\"method\":\"expected_slippage\",\"params\":{\"instrument\":";
+        json_append_string(m_buffer, instrument);
+        m_buffer += ",\"order_sz\":";
+        json_append_number(m_buffer, order_sz);
+        m_buffer += ",\"fee_pct\":";
+        json_append_number(m_buffer, fee_pct);
+        m_buffer += ",\"volatility_pct\":";
+        json_append_number(m_buffer, volatility_pct);
+        m_buffer += ",\"asks\":";
+        append_book_levels(m_buffer, book.asks, false);
+        m_buffer += ",\"bids\":";
+        append_book_levels(m_buffer, book.bids, false);
+        m_buffer += "}}";
+
+        return m_buffer;
+    }
+
+    const std::string& buffer() const { return m_buffer; }
+
+    // the response is read into this buffer, also reused
+    std::string& response() { return m_response; }
+private:
+    std::string m_buffer;
+    std::string m_response;
+};
@@ -1,25 +1,102 @@
 import socket
+import struct
 import threading
 import json
 import pickle
+import hashlib
+import os
+import time
 
 from predict_slippage import predict_slippage_runtime
 
 MAX_BUFFER = 16384
 
-eth_model = None
-btc_model = None
-models_dict = None
+# every message, request or response, is a 4 byte big endian length followed by the JSON body
+# (see model_client.h); a request is handled only once all of it has arrived
+FRAME_HEADER = struct.Struct("!I")
+MAX_MESSAGE = 64 << 20
 
-def calc_expected_slippage(params):
-    if params["instrument"] not in models_dict:
+MODEL_FILES = {
+    "BTC": "btc_slippage_model.bin",
+    "ETH": "eth_slippage_model.bin",
+}
+
+# seconds between checks of the model files, 0 disables the watcher
+RELOAD_INTERVAL = float(os.environ.get("MODEL_RELOAD_INTERVAL", "2"))
+
+# Slippage models, reloaded as a whole when the files change
+# Requests take a (models, version) snapshot when they start, so a reload only affects later
+# requests while in-flight ones finish on the version they started with
+class ModelRegistry:
+    def __init__(self, files):
+        self.files = files
+        self.lock = threading.Lock()
+        self.snapshot = ({}, None)
+        self.generation = 0
+        self.stamps = None
+
+    def current(self):
+        return self.snapshot
+
+    def file_stamps(self):
+        return {name: (os.stat(path).st_mtime_ns, os.stat(path).st_size) for name, path in self.files.items()}
+
+    # loads every model file and swaps them in together, returns the serving version
+    # on failure (e.g. a file being rewritten) the previous set keeps serving
+    def reload(self, force=False):
+        with self.lock:
+            try:
+                stamps = self.file_stamps()
+                if not force and stamps == self.stamps:
+                    return self.snapshot[1]
+
+                models = {}
+                digest = hashlib.sha256()
+                for name, path in sorted(self.files.items()):
+                    with open(path, "rb") as f:
+                        data = f.read()
+                    models[name] = pickle.loads(data)
+                    digest.update(data)
+            except Exception as e:
+                print(f"Model reload failed, serving version {self.snapshot[1]}: {e}")
+                return self.snapshot[1]
+
+            self.stamps = stamps
+
+            # rewritten with the same contents, keep the version
+            if self.snapshot[1] is not None and self.snapshot[1].endswith(digest.hexdigest()[:12]):
+                return self.snapshot[1]
+
+            self.generation += 1
+            self.snapshot = (models, f"{self.generation}-{digest.hexdigest()[:12]}")
+
+            print(f"Serving model version {self.snapshot[1]}")
+            return self.snapshot[1]
+
+    def watch(self, interval):
+        while True:
+            time.sleep(interval)
+            self.reload()
+
+registry = ModelRegistry(MODEL_FILES)
+
+def calc_expected_slippage(params, models):
+    if params["instrument"] not in models:
         return {"error": f"Unsupported instrument: {params["instrument"]}"}
 
-    selected_model = models_dict[params["instrument"]]
+    selected_model = models[params["instrument"]]
     return {"result": predict_slippage_runtime(selected_model, params)}
 
+def ping(params, models):
+    return {"result": "pong"}
+
+def reload_models(params, models):
+    return {"result": {"model_version": registry.reload(force=True)}}
+
 FUNCTION_MAP = {
     "expected_slippage": calc_expected_slippage,
+    "ping": ping,
+    "reload_models": reload_models,
 }
 
 def handle_request(data):
@@ -29,24 +106,62 @@ def handle_request(data):
         params = request["params"]
 
         if func_name in FUNCTION_MAP:
-            result = FUNCTION_MAP[func_name](params)
+            # one snapshot for the whole request, a concurrent reload does not affect it
+            models, version = registry.current()
+            result = FUNCTION_MAP[func_name](params, models)
+            result["model_version"] = version
             return json.dumps(result)
         else:
             return json.dumps({"error": f"Unknown function: {func_name}"})
     except Exception as e:
         return json.dumps({"error": str(e)})
 
+# reads exactly size bytes, None if the peer closed before the first one
+def recv_exact(conn, size):
+    data = bytearray(size)
+    view = memoryview(data)
+    received = 0
+
+    while received < size:
+        n = conn.recv_into(view[received:], min(size - received, MAX_BUFFER))
+        if n == 0:
+            if received == 0:
+                return None
+            raise ConnectionError(f"closed after {received} of {size} bytes")
+        received += n
+
+    return data
+
+# next request body, None once the client closed the connection between requests
+def recv_message(conn):
+    header = recv_exact(conn, FRAME_HEADER.size)
+    if header is None:
+        return None
+
+    (length,) = FRAME_HEADER.unpack(header)
+    if length > MAX_MESSAGE:
+        raise ValueError(f"request of {length} bytes exceeds the {MAX_MESSAGE} byte limit")
+
+    data = recv_exact(conn, length) if length > 0 else bytearray()
+    if data is None:
+        raise ConnectionError("closed before the request body")
+
+    return data
+
+def send_message(conn, payload):
+    conn.sendall(FRAME_HEADER.pack(len(payload)) + payload)
+
 def handle_client(conn, addr):
     print(f"Connected by {addr}")
     with conn:
         while True:
             try:
-                data = conn.recv(MAX_BUFFER)
-                if not data:
+                data = recv_message(conn)
+                if data is None:
                     print(f"Connection closed by {addr}")
                     break
                 response = handle_request(data.decode())
-                conn.sendall(response.encode())
+                send_message(conn, response.encode())
             except Exception as e:
                 print(f"Error with {addr}: {e}")
                 break
@@ -63,15 +178,10 @@ def start_server(host="127.0.0.1", port=9000):
         client_thread.start()
 
 if __name__ == "__main__":
-    eth_model_file = open("eth_slippage_model.bin", "rb")
-    eth_model = pickle.load(eth_model_file)
-    
-    btc_model_file = open("btc_slippage_model.bin", "rb")
-    btc_model = pickle.load(btc_model_file)
-
-    models_dict = {
-        "BTC": btc_model,
-        "ETH": eth_model
-    }
+    if registry.reload() is None:
+        raise SystemExit("Cannot load the slippage models, run train_slippage.py first")
+
+    if RELOAD_INTERVAL > 0:
+        threading.Thread(target=registry.watch, args=(RELOAD_INTERVAL,), daemon=True).start()
 
     start_server()
\ No newline at end of file
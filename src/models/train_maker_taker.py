@@ -0,0 +1,99 @@
+import argparse
+import json
+import os
+
+import numpy as np
+from sklearn.linear_model import LogisticRegression
+
+from utils import sorted_levels, extract_maker_taker_features, maker_fill_fraction, MAKER_TAKER_FEATURES
+
+# Maker/taker proportion model: logistic regression of the share of an order that fills
+# passively at the touch, from book features. Trained on a feed capture
+# (CLIENT_TRADER_RECORD_FILE) and written as plain coefficients for the C++ client
+#
+#   python train_maker_taker.py capture.jsonl --instrument BTC
+
+# order sizes each book is labelled for, USD
+ORDER_SIZES = [100, 1000, 10000, 100000, 1000000]
+
+def load_books(path, instrument):
+    books = []
+    with open(path, "r") as f:
+        for line in f:
+            try:
+                message = json.loads(line)
+            except json.JSONDecodeError:
+                continue
+
+            if not message.get("symbol", "").startswith(instrument):
+                continue
+            if not message.get("asks") or not message.get("bids"):
+                continue
+
+            books.append(sorted_levels(message))
+
+    return books
+
+def generate_dataset(books, horizon):
+    rows, fractions = [], []
+
+    for t in range(len(books) - horizon):
+        asks, bids = books[t]
+        mid_price = (asks[0][0] + bids[0][0]) / 2
+
+        for usd_quantity in ORDER_SIZES:
+            f = extract_maker_taker_features(asks, bids, usd_quantity)
+            rows.append([f[name] for name in MAKER_TAKER_FEATURES])
+            fractions.append(maker_fill_fraction(bids[0][0], usd_quantity / mid_price, books[t + 1:t + 1 + horizon]))
+
+    return np.array(rows), np.array(fractions)
+
+# a fractional label y is a maker row of weight y plus a taker row of weight 1 - y, so the
+# fitted probability is the expected maker proportion
+def train_maker_taker_model(x, fractions):
+    mean = x.mean(axis=0)
+    scale = x.std(axis=0)
+    scale[scale == 0] = 1
+
+    z = (x - mean) / scale
+    n = len(z)
+
+    model = LogisticRegression()
+    model.fit(np.vstack([z, z]), np.concatenate([np.ones(n), np.zeros(n)]),
+              sample_weight=np.concatenate([fractions, 1 - fractions]))
+
+    return {
+        "features": MAKER_TAKER_FEATURES,
+        "mean": mean.tolist(),
+        "scale": scale.tolist(),
+        "coef": model.coef_[0].tolist(),
+        "intercept": float(model.intercept_[0]),
+    }
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("capture", help="feed capture, one message per line")
+    parser.add_argument("--instrument", default="BTC")
+    parser.add_argument("--horizon", type=int, default=10, help="books an order rests before crossing")
+    args = parser.parse_args()
+
+    books = load_books(args.capture, args.instrument)
+    x, fractions = generate_dataset(books, args.horizon)
+    if len(x) == 0:
+        raise SystemExit(f"not enough {args.instrument} books in {args.capture}")
+
+    params = train_maker_taker_model(x, fractions)
+    params["instrument"] = args.instrument
+    params["horizon"] = args.horizon
+    params["samples"] = len(x)
+
+    # write then rename, the client may be reading the previous file
+    path = args.instrument.lower() + "_maker_taker.json"
+    with open(path + ".tmp", "w") as f:
+        json.dump(params, f, indent=4)
+    os.replace(path + ".tmp", path)
+
+    print(f"{path}: {len(x)} samples, mean maker share {fractions.mean():.3f}")
+
+if __name__ == "__main__":
+    main()
@@ -39,8 +39,11 @@ def train_model(pre):
     df_train = generate_dataset(historical_jsons)
     model = train_slippage_model(df_train)
 
-    with open(pre + "slippage_model.bin", "wb") as f:
+    # write then rename, so a running socket_server never loads a partial file
+    path = pre + "slippage_model.bin"
+    with open(path + ".tmp", "wb") as f:
         pickle.dump(model, f)
+    os.replace(path + ".tmp", path)
 
 train_model("eth_")
 train_model("btc_")
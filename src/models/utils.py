@@ -1,3 +1,5 @@
+import math
+
 FEATURE_COLS = ["spread_pct", "imbalance"]
 
 def extract_features(orderbook_json, usd_quantity=100, volatility=None, fee_percent=None):
@@ -41,4 +43,34 @@ def extract_features(orderbook_json, usd_quantity=100, volatility=None, fee_perc
         "volatility": volatility,
         "fee_pct": fee_percent,
         "order_qty": base_qty
-    }
\ No newline at end of file
+    }
+
+# maker/taker model, evaluated natively by src/execution/maker_taker_model.h, keep both in sync
+MAKER_TAKER_FEATURES = ["spread_bps", "imbalance", "log_size_ratio"]
+
+def sorted_levels(orderbook_json):
+    asks = sorted([(float(p), float(s)) for p, s in orderbook_json["asks"]], key=lambda x: x[0])
+    bids = sorted([(float(p), float(s)) for p, s in orderbook_json["bids"]], key=lambda x: -x[0])
+    return asks, bids
+
+def extract_maker_taker_features(asks, bids, usd_quantity):
+    best_ask, best_bid = asks[0][0], bids[0][0]
+    mid_price = (best_ask + best_bid) / 2
+
+    depth_ask = sum(size for _, size in asks[:5])
+    depth_bid = sum(size for _, size in bids[:5])
+
+    return {
+        "spread_bps": (best_ask - best_bid) / mid_price * 1e4,
+        "imbalance": (depth_bid - depth_ask) / (depth_bid + depth_ask + 1e-6),
+        "log_size_ratio": math.log1p(usd_quantity / mid_price / asks[0][1]),
+    }
+
+# share of a buy of base_qty resting at the best bid that sellers reach within the next books:
+# the largest ask quantity offered at or below the bid price over the horizon, capped at the order
+def maker_fill_fraction(bid_price, base_qty, future_books):
+    filled = 0
+    for asks, _ in future_books:
+        crossing = sum(size for price, size in asks if price <= bid_price)
+        filled = max(filled, crossing)
+    return min(1.0, filled / base_qty)
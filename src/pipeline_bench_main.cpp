@@ -0,0 +1,179 @@
+#include <iostream>
+#include <string>
+#include <cstring>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <book/book_generator.h>
+#include <book/book_writer.h>
+#include <book/book_features.h>
+#include <feed/feed_registry.h>
+#include <websocket/feed_subscriber.h>
+#include <lib/latency.h>
+#include <lib/utilities.h>
+
+std::chrono::time_point<std::chrono::high_resolution_clock> g_timer_start;
+
+constexpr size_t BENCH_LATENCY_SAMPLES = 1 << 16;
+
+// Drives generated books through the in-process part of the ingest pipeline, without sockets:
+// serialize -> feed_subscriber (as published by the I/O thread) -> feed adapter parse
+struct bench_options {
+    size_t messages = 100000;
+    double rate = 0; // messages per second, 0 publishes as fast as possible
+    std::string exchange = "OKX";
+    subscriber_options subscriber {conflation_policy::queue, 1024, true};
+    generator_options generator;
+};
+
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+        << "  --messages <n>                 messages generated (default 100000)\n"
+        << "  --rate <msgs/s>                publish rate, 0 is unpaced (default 0)\n"
+        << "  --exchange <OKX|Synthetic>     wire format and parser (default OKX)\n"
+        << "  --policy <lossless|queue|latest> subscriber conflation policy (default lossless)\n"
+        << "  --depth <n>                    levels per side (default 50)\n"
+        << "  --volatility-bps <bps>         mid move per update, standard deviation (default 0.5)\n"
+        << "  --churn <0..1>                 levels resized per update (default 0.2)\n"
+        << "  --seed <n>                     generator seed (default random)\n";
+}
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char** argv) {
+    // start global timer
+    g_timer_start = std::chrono::high_resolution_clock::now();
+
+    bench_options options;
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if(arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        }
+
+        if(i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << '\n';
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        const char* value = argv[++i];
+
+        if(arg == "--messages") options.messages = std::stoul(value);
+        else if(arg == "--rate") options.rate = std::stod(value);
+        else if(arg == "--exchange") options.exchange = value;
+        else if(arg == "--policy" && std::strcmp(value, "lossless") == 0) options.subscriber = {conflation_policy::queue, 1024, true};
+        else if(arg == "--policy" && std::strcmp(value, "queue") == 0) options.subscriber = {conflation_policy::queue, 1024, false};
+        else if(arg == "--policy" && std::strcmp(value, "latest") == 0) options.subscriber = {conflation_policy::latest};
+        else if(arg == "--depth") options.generator.depth = std::stoi(value);
+        else if(arg == "--volatility-bps") options.generator.volatility_bps = std::stod(value);
+        else if(arg == "--churn") options.generator.churn = std::stod(value);
+        else if(arg == "--seed") options.generator.seed = std::stoull(value);
+        else {
+            std::cerr << "Unknown option " << arg << '\n';
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    const feed_adapter* adapter = find_feed_adapter(options.exchange);
+    if(adapter == nullptr) {
+        std::cerr << "Unknown exchange " << options.exchange << '\n';
+        return 1;
+    }
+
+    feed_subscriber subscriber {"bench", options.subscriber};
+    std::atomic<bool> producer_done {false};
+
+    size_t produced_bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    // stands in for the websocket I/O thread
+    std::thread producer([&]() {
+        book_generator generator {adapter->exchange(), "BTC-USDT-SWAP", options.generator};
+        order_book book;
+        std::string payload;
+
+        auto next_send = std::chrono::steady_clock::now();
+        auto interval = std::chrono::nanoseconds(options.rate > 0 ? (int64_t) (1e9 / options.rate) : 0);
+
+        for(size_t i = 0; i < options.messages; i++) {
+            if(options.rate > 0) {
+                std::this_thread::sleep_until(next_send);
+                next_send += interval;
+            }
+
+            int64_t sent_ns = now_ns();
+            generator.next(book, sent_ns);
+
+            if(std::strcmp(adapter->exchange(), "Synthetic") == 0)
+                write_synthetic_book(book, payload);
+            else
+                write_okx_book(book, payload);
+
+            produced_bytes += payload.size();
+            subscriber.publish(payload, {0, sent_ns});
+        }
+
+        producer_done = true;
+    });
+
+    // consumer: parse into the native book like the GUI loop does
+    rolling_latency publish_to_parsed {BENCH_LATENCY_SAMPLES};
+    rolling_latency parse_time {BENCH_LATENCY_SAMPLES};
+    rolling_latency feature_time {BENCH_LATENCY_SAMPLES};
+    size_t parsed = 0, failed = 0;
+
+    std::vector<book_feature> feature_set;
+    parse_book_features(DEFAULT_BOOK_FEATURES, feature_set);
+    book_feature_engine features {std::move(feature_set)};
+
+    feed_message message;
+    order_book book;
+
+    while(true) {
+        if(!subscriber.wait(message, std::chrono::milliseconds(10))) {
+            if(producer_done && subscriber.stats().pending == 0)
+                break;
+            continue;
+        }
+
+        int64_t parse_start = now_ns();
+        bool ok = adapter->parse(message.payload, book);
+        int64_t parse_end = now_ns();
+
+        if(!ok) {
+            failed++;
+            continue;
+        }
+
+        parsed++;
+        parse_time.record(parse_end - parse_start);
+        publish_to_parsed.record(parse_end - message.timestamps.callback_ns);
+
+        features.update(book);
+        feature_time.record(now_ns() - parse_end);
+    }
+
+    producer.join();
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    subscriber_stats stats = subscriber.stats();
+
+    std::cout << options.exchange << ", depth " << options.generator.depth << ", " << options.messages << " messages in " << elapsed << " s\n"
+        << "  produced:  " << (options.messages / elapsed) << " msg/s, " << (produced_bytes / elapsed / (1 << 20)) << " MiB/s\n"
+        << "  delivered: " << stats.delivered << ", dropped " << stats.dropped << ", parsed " << parsed << ", failed " << failed << '\n'
+        << "  parse:     " << parse_time.summary() << '\n'
+        << "  features:  " << feature_time.summary() << '\n'
+        << "  publish to parsed: " << publish_to_parsed.summary() << '\n';
+
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+#include <iostream>
+#include <string>
+#include <cstring>
+
+#include <chrono>
+
+#include <replay_server/replay_server.h>
+#include <lib/utilities.h>
+
+std::chrono::time_point<std::chrono::high_resolution_clock> g_timer_start;
+
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+        << "  --port <n>               listen port (default 8080)\n"
+        << "  --data-dir <path>        directory of recorded L2 snapshots (default src/models/data)\n"
+        << "  --rate <msgs/s>          messages per second per instrument (default 10)\n"
+        << "  --depth <n>              levels per side, truncated or extended (default: recorded depth)\n"
+        << "  --instruments <n>        number of instruments served (default: recorded symbols)\n"
+        << "  --burst <n>              extra messages sent per burst (default 0)\n"
+        << "  --burst-interval <ms>    interval between bursts (default 1000)\n"
+        << "  --random-bursts          exponential burst sizes and intervals around --burst and --burst-interval\n"
+        << "  --max-buffered <bytes>   per connection send buffer before dropping (default 4 MiB)\n"
+        << "  --format <okx|synthetic> wire format of the messages (default okx)\n"
+        << "\n"
+        << "  --generate               serve generated books instead of the recorded snapshots\n"
+        << "  --volatility-bps <bps>   generated mid move per update, standard deviation (default 0.5)\n"
+        << "  --churn <0..1>           generated levels resized per update (default 0.2)\n"
+        << "  --seed <n>               generator seed (default random)\n";
+}
+
+int main(int argc, char** argv) {
+    // start global timer
+    g_timer_start = std::chrono::high_resolution_clock::now();
+
+    replay_options options;
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if(arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        }
+
+        if(arg == "--generate") {
+            options.generate = true;
+            continue;
+        }
+
+        if(arg == "--random-bursts") {
+            options.random_bursts = true;
+            continue;
+        }
+
+        if(i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << '\n';
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        const char* value = argv[++i];
+
+        if(arg == "--port") options.port = std::stoi(value);
+        else if(arg == "--data-dir") options.data_dir = value;
+        else if(arg == "--rate") options.rate = std::stod(value);
+        else if(arg == "--depth") options.depth = std::stoi(value);
+        else if(arg == "--instruments") options.instruments = std::stoi(value);
+        else if(arg == "--burst") options.burst_size = std::stoi(value);
+        else if(arg == "--burst-interval") options.burst_interval_ms = std::stoi(value);
+        else if(arg == "--max-buffered") options.max_buffered_bytes = std::stoul(value);
+        else if(arg == "--format" && std::strcmp(value, "okx") == 0) options.format = replay_format::okx;
+        else if(arg == "--format" && std::strcmp(value, "synthetic") == 0) options.format = replay_format::synthetic;
+        else if(arg == "--volatility-bps") options.generator.volatility_bps = std::stod(value);
+        else if(arg == "--churn") options.generator.churn = std::stod(value);
+        else if(arg == "--seed") options.generator.seed = std::stoull(value);
+        else {
+            std::cerr << "Unknown option " << arg << '\n';
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    replay_server server {options};
+
+    bool ready = options.generate ? server.generate_instruments() : server.load_snapshots();
+
+    if(!ready)
+        return 1;
+
+    server.run();
+
+    return 0;
+}
@@ -0,0 +1,439 @@
+#pragma once
+
+#include <websocketpp/config/asio_no_tls.hpp>
+#include <websocketpp/server.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+#include <book/book_generator.h>
+#include <book/book_writer.h>
+#include <lib/utilities.h>
+#include <lib/timestamp.h>
+
+typedef websocketpp::server<websocketpp::config::asio> replay_ws_server;
+
+constexpr auto REPLAY_TICK = std::chrono::milliseconds(1);
+constexpr auto REPLAY_STATS_INTERVAL = std::chrono::seconds(1);
+
+// placeholders replaced by the send time of every message
+constexpr const char* REPLAY_TIMESTAMP_PLACEHOLDER = "0000-00-00T00:00:00.000000Z";
+constexpr int64_t REPLAY_NS_PLACEHOLDER = 1000000000000000000; // 19 digits, like epoch ns until 2286
+constexpr size_t REPLAY_NS_DIGITS = 19;
+
+// wire format of the served messages
+enum class replay_format {
+    okx,      // recorded GoQuant/OKX format, decimal strings and an ISO timestamp
+    synthetic // numeric levels and an epoch nanosecond timestamp, see feed/synthetic_adapter.h
+};
+
+struct replay_options {
+    unsigned short port = 8080;
+    std::string data_dir = "src/models/data";
+    double rate = 10;              // messages per second per instrument
+    int depth = 0;                 // levels per side, 0 keeps the recorded depth
+    int instruments = 0;           // instruments served, 0 serves each recorded symbol once
+    int burst_size = 0;            // extra messages per burst, 0 disables bursts
+    int burst_interval_ms = 1000;
+    bool random_bursts = false;    // exponential burst sizes and intervals around the values above
+    size_t max_buffered_bytes = 4 << 20; // per connection, messages are dropped beyond this
+    replay_format format = replay_format::okx;
+
+    // generated books instead of the recorded snapshots
+    bool generate = false;
+    generator_options generator;
+};
+
+// generated instruments and their starting book, clones are named like the recorded ones
+struct generated_instrument {
+    const char* symbol;
+    double start_mid;
+    double tick_size;
+};
+
+constexpr generated_instrument GENERATED_INSTRUMENTS[] = {
+    {"BTC-USDT-SWAP", 100000, 0.1},
+    {"ETH-USDT-SWAP", 2500, 0.01}
+};
+
+struct replay_instrument {
+    std::string symbol;
+
+    // serialized snapshots, cycled through in order
+    std::vector<std::string> payloads;
+    std::vector<size_t> timestamp_offsets;
+    size_t next = 0;
+
+    // generated mode: a new book is serialized into payloads[0] for every message
+    std::unique_ptr<book_generator> generator;
+    order_book book;
+
+    // messages owed by the rate limiter
+    double credit = 0;
+
+    std::set<websocketpp::connection_hdl, std::owner_less<websocketpp::connection_hdl>> connections;
+};
+
+class replay_server {
+public:
+    replay_server(replay_options options): m_options{std::move(options)} {
+        m_server.clear_access_channels(websocketpp::log::alevel::all);
+        m_server.clear_error_channels(websocketpp::log::elevel::all);
+
+        m_server.init_asio();
+        m_server.set_reuse_addr(true);
+
+        m_server.set_open_handler(websocketpp::lib::bind(&replay_server::on_open, this, websocketpp::lib::placeholders::_1));
+        m_server.set_close_handler(websocketpp::lib::bind(&replay_server::on_close, this, websocketpp::lib::placeholders::_1));
+
+        m_timer = std::make_unique<websocketpp::lib::asio::steady_timer>(m_server.get_io_service());
+    }
+
+    // loads the recorded snapshots, grouped by symbol, and prepares the served instruments
+    bool load_snapshots() {
+        std::map<std::string, std::vector<json>> recorded;
+
+        std::error_code ec;
+        std::vector<std::filesystem::path> files;
+        for(const auto& entry : std::filesystem::directory_iterator(m_options.data_dir, ec))
+            if(entry.path().extension() == ".json")
+                files.push_back(entry.path());
+
+        if(ec) {
+            APP_LOG(log_flags::replay_server, "Cannot read data directory " << m_options.data_dir << ": " << ec.message());
+            return false;
+        }
+
+        // replay in file name order (btc_response_1, btc_response_2, ...)
+        std::sort(files.begin(), files.end());
+
+        for(const auto& path : files) {
+            std::ifstream file(path);
+            json snapshot = json::parse(file, nullptr, false);
+
+            if(snapshot.is_discarded() || !snapshot.contains("symbol") || !snapshot.contains("asks") || !snapshot.contains("bids")) {
+                APP_LOG(log_flags::replay_server, "Skipping malformed snapshot " << path);
+                continue;
+            }
+
+            recorded[snapshot["symbol"].get<std::string>()].push_back(std::move(snapshot));
+        }
+
+        if(recorded.empty()) {
+            APP_LOG(log_flags::replay_server, "No snapshots found in " << m_options.data_dir);
+            return false;
+        }
+
+        int instrument_count = m_options.instruments > 0 ? m_options.instruments : recorded.size();
+
+        // extra instruments are clones of the recorded ones, e.g. BTC2-USDT-SWAP
+        for(int i = 0; i < instrument_count; i++) {
+            auto it = std::next(recorded.begin(), i % recorded.size());
+            int clone = i / recorded.size();
+
+            std::string symbol = it->first;
+            if(clone > 0)
+                symbol.insert(symbol.find('-'), std::to_string(clone + 1));
+
+            m_instruments.push_back(make_instrument(symbol, it->second));
+        }
+
+        for(const auto& instrument : m_instruments)
+            APP_LOG(log_flags::replay_server, "Serving " << instrument.symbol << " (" << instrument.payloads.size() << " snapshots)");
+
+        return true;
+    }
+
+    // prepares generated instruments, as many as requested (default one per base instrument)
+    bool generate_instruments() {
+        constexpr int base_count = std::size(GENERATED_INSTRUMENTS);
+        int instrument_count = m_options.instruments > 0 ? m_options.instruments : base_count;
+
+        for(int i = 0; i < instrument_count; i++) {
+            const generated_instrument& base = GENERATED_INSTRUMENTS[i % base_count];
+            int clone = i / base_count;
+
+            std::string symbol = base.symbol;
+            if(clone > 0)
+                symbol.insert(symbol.find('-'), std::to_string(clone + 1));
+
+            generator_options generator = m_options.generator;
+            generator.start_mid = base.start_mid;
+            generator.tick_size = base.tick_size;
+            if(m_options.depth > 0)
+                generator.depth = m_options.depth;
+            if(generator.seed != 0)
+                generator.seed += i;
+
+            replay_instrument instrument;
+            instrument.symbol = symbol;
+            instrument.generator = std::make_unique<book_generator>(
+                m_options.format == replay_format::synthetic ? "Synthetic" : "OKX", symbol, generator);
+            instrument.payloads.emplace_back();
+
+            APP_LOG(log_flags::replay_server, "Generating " << symbol << " (" << generator.depth << " levels, "
+                << generator.volatility_bps << " bps/update, churn " << generator.churn << ")");
+
+            m_instruments.push_back(std::move(instrument));
+        }
+
+        return true;
+    }
+
+    void run() {
+        websocketpp::lib::error_code ec;
+        m_server.listen(m_options.port, ec);
+
+        if(ec) {
+            APP_LOG(log_flags::replay_server, "Listen failed on port " << m_options.port << ": " << ec.message());
+            return;
+        }
+
+        m_server.start_accept();
+
+        APP_LOG(log_flags::replay_server, "Listening on ws://127.0.0.1:" << m_options.port << "/ws/l2-orderbook/"
+            << (m_options.format == replay_format::synthetic ? "synthetic" : "okx") << "/<symbol>"
+            << " at " << m_options.rate << " msg/s per instrument");
+
+        m_last_tick = std::chrono::steady_clock::now();
+        m_next_burst = m_last_tick + std::chrono::milliseconds(m_options.burst_interval_ms);
+        m_next_stats = m_last_tick + REPLAY_STATS_INTERVAL;
+        schedule_tick();
+
+        m_server.run();
+    }
+private:
+    replay_instrument make_instrument(const std::string& symbol, const std::vector<json>& snapshots) {
+        replay_instrument instrument;
+        instrument.symbol = symbol;
+
+        for(json snapshot : snapshots) {
+            snapshot["symbol"] = symbol;
+            snapshot["timestamp"] = REPLAY_TIMESTAMP_PLACEHOLDER;
+
+            if(m_options.depth > 0) {
+                resize_depth(snapshot["asks"], m_options.depth, 1);
+                resize_depth(snapshot["bids"], m_options.depth, -1);
+            }
+
+            std::string payload;
+            if(m_options.format == replay_format::synthetic) {
+                payload = to_synthetic(snapshot).dump();
+                instrument.timestamp_offsets.push_back(payload.find(std::to_string(REPLAY_NS_PLACEHOLDER)));
+            } else {
+                payload = snapshot.dump();
+                instrument.timestamp_offsets.push_back(payload.find(REPLAY_TIMESTAMP_PLACEHOLDER));
+            }
+
+            instrument.payloads.push_back(std::move(payload));
+        }
+
+        return instrument;
+    }
+
+    static json to_synthetic(const json& snapshot) {
+        auto levels = [](const json& side) {
+            json out = json::array();
+            for(const auto& level : side)
+                out.push_back({std::stod(level[0].get<std::string>()), std::stod(level[1].get<std::string>())});
+            return out;
+        };
+
+        json out;
+        out["ts"] = REPLAY_NS_PLACEHOLDER;
+        out["sym"] = snapshot["symbol"];
+        out["a"] = levels(snapshot["asks"]);
+        out["b"] = levels(snapshot["bids"]);
+        return out;
+    }
+
+    // truncates the side to depth levels, or extends it by continuing the last price step
+    // direction is 1 for asks (ascending prices) and -1 for bids (descending prices)
+    static void resize_depth(json& levels, int depth, int direction) {
+        if(levels.empty())
+            return;
+
+        if((int) levels.size() >= depth) {
+            levels.erase(levels.begin() + depth, levels.end());
+            return;
+        }
+
+        size_t recorded = levels.size();
+        double last_price = std::stod(levels.back()[0].get<std::string>());
+        double step = recorded > 1
+            ? std::abs(last_price - std::stod(levels[recorded - 2][0].get<std::string>()))
+            : last_price * 1e-5;
+
+        if(step <= 0)
+            step = last_price * 1e-5;
+
+        char price[32];
+        for(size_t i = recorded; i < (size_t) depth; i++) {
+            last_price += direction * step;
+            std::snprintf(price, sizeof(price), "%.10g", last_price);
+            levels.push_back(json::array({price, levels[i % recorded][1]}));
+        }
+    }
+
+    replay_instrument* find_instrument(const std::string& symbol) {
+        for(auto& instrument : m_instruments)
+            if(instrument.symbol == symbol)
+                return &instrument;
+
+        return nullptr;
+    }
+
+    void on_open(websocketpp::connection_hdl hdl) {
+        replay_ws_server::connection_ptr con = m_server.get_con_from_hdl(hdl);
+
+        // the symbol is the last path segment, e.g. /ws/l2-orderbook/okx/BTC-USDT-SWAP
+        std::string resource = con->get_resource();
+        std::string symbol = resource.substr(resource.find_last_of('/') + 1);
+
+        replay_instrument* instrument = find_instrument(symbol);
+
+        if(instrument == nullptr) {
+            APP_LOG(log_flags::replay_server, "Rejecting unknown instrument " << symbol);
+
+            websocketpp::lib::error_code ec;
+            m_server.close(hdl, websocketpp::close::status::policy_violation, "unknown instrument", ec);
+            return;
+        }
+
+        instrument->connections.insert(hdl);
+        APP_LOG(log_flags::replay_server, "Client subscribed to " << symbol);
+    }
+
+    void on_close(websocketpp::connection_hdl hdl) {
+        for(auto& instrument : m_instruments)
+            instrument.connections.erase(hdl);
+    }
+
+    void schedule_tick() {
+        m_timer->expires_after(REPLAY_TICK);
+        m_timer->async_wait([this](const websocketpp::lib::asio::error_code& ec) {
+            if(!ec)
+                on_tick();
+        });
+    }
+
+    void on_tick() {
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - m_last_tick).count();
+        m_last_tick = now;
+
+        bool burst = m_options.burst_size > 0 && now >= m_next_burst;
+        double burst_size = m_options.burst_size;
+
+        if(burst && m_options.random_bursts) {
+            // bursts arrive as a poisson process with exponentially distributed sizes
+            burst_size = std::round(std::exponential_distribution<double>(1.0 / m_options.burst_size)(m_rng));
+            double interval_ms = std::exponential_distribution<double>(1.0 / m_options.burst_interval_ms)(m_rng);
+            m_next_burst = now + std::chrono::microseconds((int64_t) (interval_ms * 1000));
+        } else if(burst) {
+            m_next_burst += std::chrono::milliseconds(m_options.burst_interval_ms);
+        }
+
+        // cap the backlog so a stalled tick does not turn into an unbounded catch-up
+        double max_credit = std::max(1.0, m_options.rate * 0.1) + burst_size;
+
+        for(auto& instrument : m_instruments) {
+            instrument.credit = std::min(instrument.credit + m_options.rate * elapsed, max_credit);
+
+            if(burst)
+                instrument.credit += burst_size;
+
+            for(; instrument.credit >= 1; instrument.credit -= 1)
+                publish(instrument);
+        }
+
+        if(now >= m_next_stats) {
+            APP_LOG(log_flags::replay_server, "sent " << m_sent << " msgs (" << (m_sent_bytes >> 10) << " KiB), dropped " << m_dropped);
+
+            m_sent = m_sent_bytes = m_dropped = 0;
+            m_next_stats += REPLAY_STATS_INTERVAL;
+        }
+
+        schedule_tick();
+    }
+
+    // stamps the next recorded snapshot, or serializes a new generated book
+    const std::string& next_payload(replay_instrument& instrument) {
+        if(instrument.generator) {
+            int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+
+            instrument.generator->next(instrument.book, now_ns);
+
+            std::string& payload = instrument.payloads[0];
+            if(m_options.format == replay_format::synthetic)
+                write_synthetic_book(instrument.book, payload);
+            else
+                write_okx_book(instrument.book, payload);
+
+            return payload;
+        }
+
+        std::string& payload = instrument.payloads[instrument.next];
+        char* timestamp = &payload[instrument.timestamp_offsets[instrument.next]];
+
+        if(m_options.format == replay_format::synthetic) {
+            int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            for(int i = REPLAY_NS_DIGITS - 1; i >= 0; i--, now_ns /= 10)
+                timestamp[i] = '0' + now_ns % 10;
+        } else {
+            format_iso_timestamp_us(timestamp, std::chrono::system_clock::now());
+        }
+
+        instrument.next = (instrument.next + 1) % instrument.payloads.size();
+        return payload;
+    }
+
+    void publish(replay_instrument& instrument) {
+        const std::string& payload = next_payload(instrument);
+
+        for(const auto& hdl : instrument.connections) {
+            websocketpp::lib::error_code ec;
+            replay_ws_server::connection_ptr con = m_server.get_con_from_hdl(hdl, ec);
+
+            // slow consumer: drop instead of queueing without bound
+            if(ec || con->get_buffered_amount() > m_options.max_buffered_bytes) {
+                m_dropped++;
+                continue;
+            }
+
+            con->send(payload, websocketpp::frame::opcode::text);
+            m_sent++;
+            m_sent_bytes += payload.size();
+        }
+    }
+
+    replay_options m_options;
+    replay_ws_server m_server;
+    std::unique_ptr<websocketpp::lib::asio::steady_timer> m_timer;
+
+    std::vector<replay_instrument> m_instruments;
+    std::mt19937_64 m_rng {std::random_device{}()};
+
+    std::chrono::steady_clock::time_point m_last_tick;
+    std::chrono::steady_clock::time_point m_next_burst;
+    std::chrono::steady_clock::time_point m_next_stats;
+
+    size_t m_sent = 0;
+    size_t m_sent_bytes = 0;
+    size_t m_dropped = 0;
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+constexpr size_t FEED_HISTOGRAM_BUCKETS = 32;
+constexpr auto FEED_RATE_WINDOW = std::chrono::seconds(1);
+
+// Histogram with power of two buckets: bucket 0 holds 0, bucket i holds [2^(i-1), 2^i)
+// Written by a single thread (the websocket I/O thread), readable from any thread
+template <size_t N>
+class log2_histogram {
+public:
+    void record(uint64_t value) {
+        m_buckets[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void copy_to(std::array<uint64_t, N>& out) const {
+        for(size_t i = 0; i < N; i++)
+            out[i] = m_buckets[i].load(std::memory_order_relaxed);
+    }
+
+    static size_t bucket_of(uint64_t value) {
+        if(value == 0)
+            return 0;
+
+        size_t bucket = 64 - __builtin_clzll(value);
+        return bucket < N ? bucket : N - 1;
+    }
+
+    // exclusive upper bound of a bucket
+    static uint64_t upper_bound(size_t bucket) {
+        return 1ull << bucket;
+    }
+
+    // upper bound of the bucket holding quantile q (0 to 1)
+    static uint64_t quantile(const std::array<uint64_t, N>& buckets, double q) {
+        uint64_t total = 0;
+        for(uint64_t count : buckets)
+            total += count;
+
+        if(total == 0)
+            return 0;
+
+        uint64_t target = q * total;
+        uint64_t seen = 0;
+
+        for(size_t i = 0; i < N; i++) {
+            seen += buckets[i];
+            if(seen > target)
+                return upper_bound(i);
+        }
+
+        return upper_bound(N - 1);
+    }
+private:
+    std::array<std::atomic<uint64_t>, N> m_buckets {};
+};
+
+// point in time copy of feed_metrics, safe to hand to the GUI
+struct feed_stats {
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+    uint64_t dropped = 0; // updates conflated or evicted before a consumer read them
+
+    double msgs_per_sec = 0;
+    double bytes_per_sec = 0;
+    double since_last_msg_ms = -1; // -1 until the first message
+
+    // inter-arrival time in microseconds, message size in bytes
+    std::array<uint64_t, FEED_HISTOGRAM_BUCKETS> inter_arrival_us {};
+    std::array<uint64_t, FEED_HISTOGRAM_BUCKETS> msg_size_bytes {};
+};
+
+inline std::ostream& operator<<(std::ostream& out, const feed_stats& stats) {
+    using histogram = log2_histogram<FEED_HISTOGRAM_BUCKETS>;
+
+    out << "> Messages: " << stats.messages << " (" << stats.bytes << " bytes)\n"
+        << "> Rate: " << stats.msgs_per_sec << " msg/s, " << stats.bytes_per_sec << " bytes/s\n"
+        << "> Dropped by consumers: " << stats.dropped << "\n"
+        << "> Since last message (ms): " << stats.since_last_msg_ms << "\n"
+        << "> Inter-arrival (us) p50 < " << histogram::quantile(stats.inter_arrival_us, 0.5)
+        << ", p99 < " << histogram::quantile(stats.inter_arrival_us, 0.99) << "\n"
+        << "> Message size (bytes) p50 < " << histogram::quantile(stats.msg_size_bytes, 0.5)
+        << ", p99 < " << histogram::quantile(stats.msg_size_bytes, 0.99) << "\n";
+
+    return out;
+}
+
+// Per-connection feed counters, updated from the websocket I/O thread
+class feed_metrics {
+public:
+    typedef std::chrono::steady_clock clock;
+
+    void record_message(size_t bytes, clock::time_point now) {
+        int64_t now_ns = to_ns(now);
+        int64_t last_ns = m_last_msg_ns.exchange(now_ns, std::memory_order_relaxed);
+
+        if(last_ns != 0)
+            m_inter_arrival_us.record((now_ns - last_ns) / 1000);
+
+        m_msg_size_bytes.record(bytes);
+        m_messages.fetch_add(1, std::memory_order_relaxed);
+        m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+        // close the rate window once a second
+        if(m_window_start_ns == 0)
+            m_window_start_ns = now_ns;
+
+        m_window_messages++;
+        m_window_bytes += bytes;
+
+        int64_t window_ns = now_ns - m_window_start_ns;
+        if(window_ns >= std::chrono::nanoseconds(FEED_RATE_WINDOW).count()) {
+            m_msgs_per_sec.store(m_window_messages * 1e9 / window_ns, std::memory_order_relaxed);
+            m_bytes_per_sec.store(m_window_bytes * 1e9 / window_ns, std::memory_order_relaxed);
+
+            m_window_start_ns = now_ns;
+            m_window_messages = 0;
+            m_window_bytes = 0;
+        }
+    }
+
+    feed_stats snapshot(clock::time_point now) const {
+        feed_stats stats;
+
+        stats.messages = m_messages.load(std::memory_order_relaxed);
+        stats.bytes = m_bytes.load(std::memory_order_relaxed);
+
+        int64_t last_ns = m_last_msg_ns.load(std::memory_order_relaxed);
+        if(last_ns != 0)
+            stats.since_last_msg_ms = (to_ns(now) - last_ns) / 1e6;
+
+        // the rate is only refreshed by incoming messages, report zero for a stalled feed
+        bool stalled = stats.since_last_msg_ms > 2 * std::chrono::duration<double, std::milli>(FEED_RATE_WINDOW).count();
+        stats.msgs_per_sec = stalled ? 0 : m_msgs_per_sec.load(std::memory_order_relaxed);
+        stats.bytes_per_sec = stalled ? 0 : m_bytes_per_sec.load(std::memory_order_relaxed);
+
+        m_inter_arrival_us.copy_to(stats.inter_arrival_us);
+        m_msg_size_bytes.copy_to(stats.msg_size_bytes);
+
+        return stats;
+    }
+private:
+    static int64_t to_ns(clock::time_point tp) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+    }
+
+    std::atomic<uint64_t> m_messages {0};
+    std::atomic<uint64_t> m_bytes {0};
+    std::atomic<int64_t> m_last_msg_ns {0};
+
+    std::atomic<double> m_msgs_per_sec {0};
+    std::atomic<double> m_bytes_per_sec {0};
+
+    log2_histogram<FEED_HISTOGRAM_BUCKETS> m_inter_arrival_us;
+    log2_histogram<FEED_HISTOGRAM_BUCKETS> m_msg_size_bytes;
+
+    // writer-only rate window state
+    int64_t m_window_start_ns = 0;
+    uint64_t m_window_messages = 0;
+    uint64_t m_window_bytes = 0;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <lib/thread_tuning.h>
+#include <lib/utilities.h>
+#include <websocket/feed_subscriber.h>
+
+constexpr size_t FEED_RECORDER_QUEUE_DEPTH = 4096;
+constexpr auto FEED_RECORDER_POLL = std::chrono::milliseconds(100);
+
+// Writes every received message to a capture file, one message per line (JSON lines)
+// Uses a lossless queue: when the disk falls behind the I/O thread waits rather than dropping
+class feed_recorder {
+public:
+    feed_recorder(const std::string& path, size_t queue_depth = FEED_RECORDER_QUEUE_DEPTH)
+        : m_file(path, std::ios::out | std::ios::app) {
+        subscriber_options options;
+        options.policy = conflation_policy::queue;
+        options.queue_depth = queue_depth;
+        options.lossless = true;
+
+        m_subscriber = std::make_shared<feed_subscriber>("recorder", options);
+
+        if(!m_file) {
+            APP_LOG(log_flags::client_trader, "Failed to open capture file " << path);
+            return;
+        }
+
+        APP_LOG(log_flags::client_trader, "Recording feed to " << path);
+        m_thread = std::thread(&feed_recorder::run, this);
+    }
+
+    ~feed_recorder() {
+        m_stop = true;
+        m_subscriber->close();
+
+        if(m_thread.joinable())
+            m_thread.join();
+    }
+
+    // false if the capture file could not be opened; nothing drains the subscriber then, so it
+    // must not be attached (a lossless queue would block the I/O thread once full)
+    bool is_open() const { return m_thread.joinable(); }
+
+    // attach to every connection that should be captured
+    feed_subscriber::ptr subscriber() const { return m_subscriber; }
+private:
+    void run() {
+        // not the tuning of whichever thread enabled recording
+        apply_thread_tuning({}, "recorder");
+
+        feed_message message;
+
+        while(true) {
+            if(!m_subscriber->wait(message, FEED_RECORDER_POLL)) {
+                if(m_stop)
+                    break;
+                continue;
+            }
+
+            // raw newlines can only be insignificant whitespace in JSON, flatten to one line
+            std::replace(message.payload.begin(), message.payload.end(), '\n', ' ');
+            std::replace(message.payload.begin(), message.payload.end(), '\r', ' ');
+
+            m_file.write(message.payload.data(), message.payload.size());
+            m_file.put('\n');
+        }
+
+        m_file.flush();
+    }
+
+    std::ofstream m_file;
+    feed_subscriber::ptr m_subscriber;
+    std::atomic<bool> m_stop {false};
+    std::thread m_thread;
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr size_t FEED_QUEUE_DEPTH = 64;
+constexpr size_t FEED_SLOT_RESERVE = 16384; // bytes preallocated per queued message
+
+// receive times of a message in nanoseconds since epoch (system clock)
+struct message_timestamps {
+    int64_t kernel_ns = 0; // last packet of the frame reached the socket, 0 if unavailable
+    int64_t callback_ns = 0; // on_message was dispatched
+};
+
+struct feed_message {
+    std::string payload;
+    message_timestamps timestamps;
+};
+
+// How a consumer that reads slower than the feed sees the stream
+enum class conflation_policy {
+    latest,   // only the newest update is kept, older unread ones are dropped
+    queue,    // every update is queued up to queue_depth
+    throttle  // at most one update per throttle_interval, the newest one wins
+};
+
+struct subscriber_options {
+    conflation_policy policy = conflation_policy::latest;
+
+    // queue: bounded depth, and whether a full queue blocks the producer (never drops)
+    // instead of dropping the oldest update
+    size_t queue_depth = FEED_QUEUE_DEPTH;
+    bool lossless = false;
+
+    // throttle: minimum time between two delivered updates
+    std::chrono::milliseconds throttle_interval {100};
+};
+
+struct subscriber_stats {
+    uint64_t published = 0;
+    uint64_t delivered = 0;
+    uint64_t dropped = 0; // conflated or evicted before the consumer read them
+    size_t pending = 0;
+};
+
+// Hand-off point between the websocket I/O thread and one consumer of the book stream
+// Message buffers are swapped rather than copied, so steady state runs without allocation
+class feed_subscriber {
+public:
+    typedef std::shared_ptr<feed_subscriber> ptr;
+    typedef std::chrono::steady_clock clock;
+
+    feed_subscriber(std::string name, subscriber_options options = {})
+        : m_name{std::move(name)}
+        , m_options{options}
+        , m_slots(options.policy == conflation_policy::queue && options.queue_depth > 0 ? options.queue_depth : 1) {
+        for(auto& slot : m_slots)
+            slot.payload.reserve(FEED_SLOT_RESERVE);
+    }
+
+    // producer side, called from the I/O thread
+    void publish(std::string_view payload, const message_timestamps& timestamps) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_stats.published++;
+
+        if(m_options.policy == conflation_policy::queue && m_count == m_slots.size()) {
+            if(m_options.lossless) {
+                // backpressure onto the producer, the consumer must keep up on average
+                m_not_full.wait(lock, [this]() { return m_count < m_slots.size() || m_closed; });
+                if(m_closed)
+                    return;
+            } else {
+                // evict the oldest update
+                m_head = (m_head + 1) % m_slots.size();
+                m_count--;
+                m_stats.dropped++;
+            }
+        }
+
+        if(m_options.policy != conflation_policy::queue && m_count == 1) {
+            // overwrite the unread update
+            m_count = 0;
+            m_stats.dropped++;
+        }
+
+        feed_message& slot = m_slots[(m_head + m_count) % m_slots.size()];
+        slot.payload.assign(payload.data(), payload.size());
+        slot.timestamps = timestamps;
+        m_count++;
+
+        m_not_empty.notify_one();
+    }
+
+    // consumer side: moves the next update into out, false if none is due
+    bool poll(feed_message& out) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return pop(out, clock::now());
+    }
+
+    // blocks up to timeout for an update, used by consumers with their own thread
+    bool wait(feed_message& out, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_empty.wait_for(lock, timeout, [this]() { return m_count > 0 || m_closed; });
+        return pop(out, clock::now());
+    }
+
+    // releases a producer blocked on a full lossless queue
+    void close() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_not_full.notify_all();
+        m_not_empty.notify_all();
+    }
+
+    subscriber_stats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        subscriber_stats stats = m_stats;
+        stats.pending = m_count;
+        return stats;
+    }
+
+    const std::string& name() const { return m_name; }
+    const subscriber_options& options() const { return m_options; }
+private:
+    bool pop(feed_message& out, clock::time_point now) {
+        if(m_count == 0)
+            return false;
+
+        if(m_options.policy == conflation_policy::throttle && now - m_last_delivery < m_options.throttle_interval)
+            return false;
+
+        // hand the buffer to the consumer and recycle its previous one
+        feed_message& slot = m_slots[m_head];
+        std::swap(out.payload, slot.payload);
+        out.timestamps = slot.timestamps;
+
+        m_head = (m_head + 1) % m_slots.size();
+        m_count--;
+
+        m_stats.delivered++;
+        m_last_delivery = now;
+        m_not_full.notify_one();
+
+        return true;
+    }
+
+    std::string m_name;
+    subscriber_options m_options;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_not_full;
+    std::condition_variable m_not_empty;
+
+    std::vector<feed_message> m_slots;
+    size_t m_head = 0;
+    size_t m_count = 0;
+    bool m_closed = false;
+
+    clock::time_point m_last_delivery {};
+    subscriber_stats m_stats;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr size_t WS_HISTORY_CAPACITY = 64;
+constexpr size_t WS_HISTORY_SLOT_RESERVE = 16384; // bytes preallocated per message slot
+
+// Fixed capacity history of the most recent messages, oldest entries are overwritten
+// Slots keep their capacity, so once warmed up push() does not allocate
+class message_ring {
+public:
+    message_ring(size_t capacity = WS_HISTORY_CAPACITY, size_t slot_reserve = WS_HISTORY_SLOT_RESERVE)
+        : m_slots(capacity > 0 ? capacity : 1) {
+        for(auto& slot : m_slots)
+            slot.reserve(slot_reserve);
+    }
+
+    // stores prefix + payload, e.g. "RECV: " + message
+    void push(std::string_view prefix, std::string_view payload) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        std::string& slot = m_slots[m_next];
+        slot.assign(prefix.data(), prefix.size());
+        slot.append(payload.data(), payload.size());
+
+        m_next = (m_next + 1) % m_slots.size();
+        if(m_size < m_slots.size())
+            m_size++;
+    }
+
+    // visits the stored messages from oldest to newest, holding the lock
+    template <typename visitor_type>
+    void for_each(visitor_type visitor) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        size_t first = (m_next + m_slots.size() - m_size) % m_slots.size();
+        for(size_t i = 0; i < m_size; i++)
+            visitor(m_slots[(first + i) % m_slots.size()]);
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_size;
+    }
+
+    size_t capacity() const { return m_slots.size(); }
+private:
+    mutable std::mutex m_mutex;
+    std::vector<std::string> m_slots;
+    size_t m_next = 0;
+    size_t m_size = 0;
+};
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include <boost/asio.hpp>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+constexpr size_t TIMESTAMPED_READ_MAX_BUFFERS = 16;
+
+// TCP socket that reads with recvmsg() to get the kernel arrival time of the data
+// SIOCGSTAMPNS only answers for datagram sockets (ENOENT on TCP); a stream socket reports
+// SO_TIMESTAMPNS as an SCM_TIMESTAMPNS control message of each recvmsg(), the arrival of the last
+// segment read. asio reads without a control buffer, so async_read_some is replaced here and
+// the websocket transports (websocket/timestamped_transport.h) use this socket for plain
+// connections and as the next layer of tls streams
+class timestamped_tcp_socket : public boost::asio::ip::tcp::socket {
+public:
+    using base = boost::asio::ip::tcp::socket;
+    using base::base;
+
+    // turns on SO_TIMESTAMPNS, false if the socket refuses it (errno is set)
+    bool enable_kernel_timestamps() {
+#ifdef __linux__
+        int enable = 1;
+        m_timestamps = setsockopt(native_handle(), SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) == 0;
+#endif
+        return m_timestamps;
+    }
+
+    bool kernel_timestamps() const { return m_timestamps; }
+
+    // arrival of the last segment read, nanoseconds since epoch, 0 before the first timestamped read
+    int64_t kernel_receive_ns() const { return m_receive_ns; }
+
+    // hides base::async_read_some, asio's composed reads and ssl::stream call it by name
+    template <typename MutableBufferSequence, typename ReadHandler>
+    void async_read_some(const MutableBufferSequence& buffers, ReadHandler&& handler) {
+        if (!m_timestamps) {
+            base::async_read_some(buffers, std::forward<ReadHandler>(handler));
+            return;
+        }
+
+        start_read(buffers, std::forward<ReadHandler>(handler));
+    }
+private:
+    template <typename ReadHandler>
+    struct read_completion {
+        ReadHandler handler;
+        boost::system::error_code ec;
+        size_t bytes;
+
+        void operator()() { handler(ec, bytes); }
+    };
+
+    // tries the read right away like asio does, otherwise waits until the socket is readable
+    // and reads from the wait's completion, the way asio's reactor performs its reads
+    template <typename MutableBufferSequence, typename ReadHandler>
+    void start_read(const MutableBufferSequence& buffers, ReadHandler&& handler, bool from_wait = false) {
+        boost::system::error_code ec;
+        size_t bytes = 0;
+
+        if (!read_timestamped(buffers, ec, bytes) && !ec) {
+            async_wait(base::wait_read,
+                [this, buffers, handler = std::forward<ReadHandler>(handler)](const boost::system::error_code& wait_ec) mutable {
+                    if (wait_ec) {
+                        complete(read_completion<std::decay_t<ReadHandler>> {std::move(handler), wait_ec, 0}, true);
+                        return;
+                    }
+
+                    start_read(buffers, std::move(handler), true);
+                });
+            return;
+        }
+
+        complete(read_completion<std::decay_t<ReadHandler>> {std::forward<ReadHandler>(handler), ec, bytes}, from_wait);
+    }
+
+    // posted when the read finished inside async_read_some, as asio never completes inline
+    // Handlers without an executor of their own go through
+    // their asio_handler_invoke hook like asio's own completions: websocketpp wraps its reads
+    // with a legacy strand (io_service::strand::wrap), which only dispatches through that hook
+    template <typename ReadHandler>
+    void complete(read_completion<ReadHandler> completion, bool from_wait) {
+        auto executor = boost::asio::get_associated_executor(completion.handler, get_executor());
+
+        if (!std::is_same<decltype(executor), executor_type>::value) {
+            if (from_wait)
+                boost::asio::dispatch(executor, std::move(completion));
+            else
+                boost::asio::post(executor, std::move(completion));
+            return;
+        }
+
+        if (from_wait) {
+            boost_asio_handler_invoke_helpers::invoke(completion, completion.handler);
+            return;
+        }
+
+        boost::asio::post(get_executor(), [completion = std::move(completion)]() mutable {
+            boost_asio_handler_invoke_helpers::invoke(completion, completion.handler);
+        });
+    }
+
+    // one non-blocking recvmsg(), false with no error if nothing is pending
+    template <typename MutableBufferSequence>
+    bool read_timestamped(const MutableBufferSequence& buffers, boost::system::error_code& ec, size_t& bytes) {
+#ifdef __linux__
+        iovec iov[TIMESTAMPED_READ_MAX_BUFFERS];
+        size_t count = 0;
+        size_t total = 0;
+
+        for (auto it = boost::asio::buffer_sequence_begin(buffers); it != boost::asio::buffer_sequence_end(buffers) && count < TIMESTAMPED_READ_MAX_BUFFERS; ++it) {
+            boost::asio::mutable_buffer buffer(*it);
+            iov[count].iov_base = buffer.data();
+            iov[count].iov_len = buffer.size();
+            total += buffer.size();
+            count++;
+        }
+
+        // asio completes empty reads at once
+        if (total == 0)
+            return true;
+
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(timespec))];
+
+        msghdr msg {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        ssize_t result;
+        do {
+            result = recvmsg(native_handle(), &msg, MSG_DONTWAIT);
+        } while (result < 0 && errno == EINTR);
+
+        if (result < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                ec = boost::system::error_code(errno, boost::asio::error::get_system_category());
+            return false;
+        }
+
+        if (result == 0) {
+            ec = boost::asio::error::eof;
+            return true;
+        }
+
+        for (cmsghdr* header = CMSG_FIRSTHDR(&msg); header != nullptr; header = CMSG_NXTHDR(&msg, header)) {
+            if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_TIMESTAMPNS) {
+                timespec ts;
+                std::memcpy(&ts, CMSG_DATA(header), sizeof(ts));
+                m_receive_ns = ts.tv_sec * 1000000000ll + ts.tv_nsec;
+            }
+        }
+
+        bytes = static_cast<size_t>(result);
+        return true;
+#else
+        (void) buffers;
+        ec = boost::asio::error::operation_not_supported;
+        bytes = 0;
+        return true;
+#endif
+    }
+
+    bool m_timestamps = false;
+    int64_t m_receive_ns = 0;
+};
@@ -0,0 +1,347 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+
+#include <websocketpp/config/asio_client.hpp>
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/transport/asio/security/base.hpp>
+#include <websocketpp/uri.hpp>
+
+#include <websocket/timestamped_socket.h>
+
+// websocketpp socket policies over timestamped_tcp_socket, so frames can be given the kernel
+// arrival time of their data (see endpoint_options::kernel_timestamps)
+// They follow websocketpp's own basic_socket and tls_socket policies, only the socket type
+// differs; get_next_layer() returns the timestamped socket for both transports
+namespace timestamped_transport {
+
+namespace socket = websocketpp::transport::asio::socket;
+namespace lib = websocketpp::lib;
+using websocketpp::connection_hdl;
+using websocketpp::uri_ptr;
+
+namespace plain {
+
+typedef lib::function<void(connection_hdl, timestamped_tcp_socket&)> socket_init_handler;
+
+class connection : public lib::enable_shared_from_this<connection> {
+public:
+    typedef connection type;
+    typedef lib::shared_ptr<type> ptr;
+    typedef lib::asio::io_service* io_service_ptr;
+    typedef lib::shared_ptr<lib::asio::io_service::strand> strand_ptr;
+    typedef timestamped_tcp_socket socket_type;
+    typedef lib::shared_ptr<socket_type> socket_ptr;
+
+    explicit connection() : m_state(UNINITIALIZED) {}
+
+    ptr get_shared() { return shared_from_this(); }
+
+    bool is_secure() const { return false; }
+
+    void set_socket_init_handler(socket_init_handler h) { m_socket_init_handler = h; }
+
+    socket_type& get_socket() { return *m_socket; }
+    socket_type& get_next_layer() { return *m_socket; }
+    socket_type& get_raw_socket() { return *m_socket; }
+
+    std::string get_remote_endpoint(lib::error_code& ec) const {
+        std::stringstream s;
+
+        lib::asio::error_code aec;
+        lib::asio::ip::tcp::endpoint ep = m_socket->remote_endpoint(aec);
+
+        if (aec) {
+            ec = websocketpp::transport::asio::error::make_error_code(websocketpp::transport::asio::error::pass_through);
+            s << "Error getting remote endpoint: " << aec << " (" << aec.message() << ")";
+        } else {
+            ec = lib::error_code();
+            s << ep;
+        }
+
+        return s.str();
+    }
+protected:
+    lib::error_code init_asio(io_service_ptr service, strand_ptr, bool) {
+        if (m_state != UNINITIALIZED)
+            return socket::make_error_code(socket::error::invalid_state);
+
+        m_socket = lib::make_shared<socket_type>(*service);
+
+        if (m_socket_init_handler)
+            m_socket_init_handler(m_hdl, *m_socket);
+
+        m_state = READY;
+        return lib::error_code();
+    }
+
+    void set_uri(uri_ptr) {}
+
+    void pre_init(socket::init_handler callback) {
+        if (m_state != READY) {
+            callback(socket::make_error_code(socket::error::invalid_state));
+            return;
+        }
+
+        m_state = READING;
+        callback(lib::error_code());
+    }
+
+    void post_init(socket::init_handler callback) { callback(lib::error_code()); }
+
+    void set_handle(connection_hdl hdl) { m_hdl = hdl; }
+
+    lib::asio::error_code cancel_socket() {
+        lib::asio::error_code ec;
+        m_socket->cancel(ec);
+        return ec;
+    }
+
+    void async_shutdown(socket::shutdown_handler h) {
+        lib::asio::error_code ec;
+        m_socket->shutdown(lib::asio::ip::tcp::socket::shutdown_both, ec);
+        h(ec);
+    }
+
+    lib::error_code get_ec() const { return lib::error_code(); }
+public:
+    template <typename ErrorCodeType>
+    static lib::error_code translate_ec(ErrorCodeType) {
+        return websocketpp::transport::error::make_error_code(websocketpp::transport::error::pass_through);
+    }
+
+    static lib::error_code translate_ec(lib::error_code ec) { return ec; }
+private:
+    enum state {
+        UNINITIALIZED = 0,
+        READY = 1,
+        READING = 2
+    };
+
+    socket_ptr m_socket;
+    state m_state;
+
+    connection_hdl m_hdl;
+    socket_init_handler m_socket_init_handler;
+};
+
+class endpoint {
+public:
+    typedef endpoint type;
+    typedef connection socket_con_type;
+    typedef socket_con_type::ptr socket_con_ptr;
+
+    explicit endpoint() {}
+
+    bool is_secure() const { return false; }
+
+    void set_socket_init_handler(socket_init_handler h) { m_socket_init_handler = h; }
+protected:
+    lib::error_code init(socket_con_ptr scon) {
+        scon->set_socket_init_handler(m_socket_init_handler);
+        return lib::error_code();
+    }
+private:
+    socket_init_handler m_socket_init_handler;
+};
+
+} // namespace plain
+
+namespace tls {
+
+typedef lib::asio::ssl::stream<timestamped_tcp_socket> stream_type;
+typedef lib::function<void(connection_hdl, stream_type&)> socket_init_handler;
+typedef lib::function<lib::shared_ptr<lib::asio::ssl::context>(connection_hdl)> tls_init_handler;
+
+class connection : public lib::enable_shared_from_this<connection> {
+public:
+    typedef connection type;
+    typedef lib::shared_ptr<type> ptr;
+    typedef stream_type socket_type;
+    typedef lib::shared_ptr<socket_type> socket_ptr;
+    typedef lib::asio::io_service* io_service_ptr;
+    typedef lib::shared_ptr<lib::asio::io_service::strand> strand_ptr;
+    typedef lib::shared_ptr<lib::asio::ssl::context> context_ptr;
+
+    explicit connection() {}
+
+    ptr get_shared() { return shared_from_this(); }
+
+    bool is_secure() const { return true; }
+
+    socket_type::lowest_layer_type& get_raw_socket() { return m_socket->lowest_layer(); }
+    socket_type::next_layer_type& get_next_layer() { return m_socket->next_layer(); }
+    socket_type& get_socket() { return *m_socket; }
+
+    void set_socket_init_handler(socket_init_handler h) { m_socket_init_handler = h; }
+    void set_tls_init_handler(tls_init_handler h) { m_tls_init_handler = h; }
+
+    std::string get_remote_endpoint(lib::error_code& ec) const {
+        std::stringstream s;
+
+        lib::asio::error_code aec;
+        lib::asio::ip::tcp::endpoint ep = m_socket->lowest_layer().remote_endpoint(aec);
+
+        if (aec) {
+            ec = websocketpp::transport::asio::error::make_error_code(websocketpp::transport::asio::error::pass_through);
+            s << "Error getting remote endpoint: " << aec << " (" << aec.message() << ")";
+        } else {
+            ec = lib::error_code();
+            s << ep;
+        }
+
+        return s.str();
+    }
+protected:
+    lib::error_code init_asio(io_service_ptr service, strand_ptr strand, bool is_server) {
+        if (!m_tls_init_handler)
+            return socket::make_error_code(socket::error::missing_tls_init_handler);
+
+        m_context = m_tls_init_handler(m_hdl);
+        if (!m_context)
+            return socket::make_error_code(socket::error::invalid_tls_context);
+
+        m_socket = lib::make_shared<socket_type>(*service, *m_context);
+
+        if (m_socket_init_handler)
+            m_socket_init_handler(m_hdl, get_socket());
+
+        m_strand = strand;
+        m_is_server = is_server;
+        return lib::error_code();
+    }
+
+    void set_uri(uri_ptr u) { m_uri = u; }
+
+    void pre_init(socket::init_handler callback) {
+        // SNI for host names, IP literals are sent without it (RFC 3546 section 3.1)
+        if (!m_is_server) {
+            const std::string& host = m_uri->get_host();
+
+            lib::asio::error_code ec_addr;
+            lib::asio::ip::make_address(host, ec_addr);
+
+            if (ec_addr && SSL_set_tlsext_host_name(get_socket().native_handle(), host.c_str()) != 1) {
+                callback(socket::make_error_code(socket::error::tls_failed_sni_hostname));
+                return;
+            }
+        }
+
+        callback(lib::error_code());
+    }
+
+    void post_init(socket::init_handler callback) {
+        m_ec = socket::make_error_code(socket::error::tls_handshake_timeout);
+
+        auto handshake_type = m_is_server ? lib::asio::ssl::stream_base::server : lib::asio::ssl::stream_base::client;
+        auto handler = lib::bind(&type::handle_init, get_shared(), callback, lib::placeholders::_1);
+
+        if (m_strand)
+            m_socket->async_handshake(handshake_type, m_strand->wrap(handler));
+        else
+            m_socket->async_handshake(handshake_type, handler);
+    }
+
+    void set_handle(connection_hdl hdl) { m_hdl = hdl; }
+
+    void handle_init(socket::init_handler callback, const lib::asio::error_code& ec) {
+        m_ec = ec ? socket::make_error_code(socket::error::tls_handshake_failed) : lib::error_code();
+        callback(m_ec);
+    }
+
+    lib::error_code get_ec() const { return m_ec; }
+
+    lib::asio::error_code cancel_socket() {
+        lib::asio::error_code ec;
+        get_raw_socket().cancel(ec);
+        return ec;
+    }
+
+    void async_shutdown(socket::shutdown_handler callback) {
+        if (m_strand)
+            m_socket->async_shutdown(m_strand->wrap(callback));
+        else
+            m_socket->async_shutdown(callback);
+    }
+public:
+    template <typename ErrorCodeType>
+    static lib::error_code translate_ec(ErrorCodeType ec) {
+        // a tls error, otherwise nothing more is known about it
+        if (ec.category() == lib::asio::error::get_ssl_category())
+            return websocketpp::transport::error::make_error_code(websocketpp::transport::error::tls_error);
+
+        return websocketpp::transport::error::make_error_code(websocketpp::transport::error::pass_through);
+    }
+
+    static lib::error_code translate_ec(lib::error_code ec) { return ec; }
+private:
+    strand_ptr m_strand;
+    context_ptr m_context;
+    socket_ptr m_socket;
+    uri_ptr m_uri;
+    bool m_is_server = false;
+    lib::error_code m_ec;
+
+    connection_hdl m_hdl;
+    socket_init_handler m_socket_init_handler;
+    tls_init_handler m_tls_init_handler;
+};
+
+class endpoint {
+public:
+    typedef endpoint type;
+    typedef connection socket_con_type;
+    typedef socket_con_type::ptr socket_con_ptr;
+
+    explicit endpoint() {}
+
+    bool is_secure() const { return true; }
+
+    void set_socket_init_handler(socket_init_handler h) { m_socket_init_handler = h; }
+    void set_tls_init_handler(tls_init_handler h) { m_tls_init_handler = h; }
+protected:
+    lib::error_code init(socket_con_ptr scon) {
+        scon->set_socket_init_handler(m_socket_init_handler);
+        scon->set_tls_init_handler(m_tls_init_handler);
+        return lib::error_code();
+    }
+private:
+    socket_init_handler m_socket_init_handler;
+    tls_init_handler m_tls_init_handler;
+};
+
+} // namespace tls
+
+// websocketpp's asio client configs with the socket policy swapped
+template <typename base_config, typename socket_policy>
+struct client_config : public base_config {
+    typedef client_config type;
+    typedef base_config base;
+
+    typedef typename base::concurrency_type concurrency_type;
+    typedef typename base::request_type request_type;
+    typedef typename base::response_type response_type;
+    typedef typename base::message_type message_type;
+    typedef typename base::con_msg_manager_type con_msg_manager_type;
+    typedef typename base::endpoint_msg_manager_type endpoint_msg_manager_type;
+    typedef typename base::alog_type alog_type;
+    typedef typename base::elog_type elog_type;
+    typedef typename base::rng_type rng_type;
+
+    struct transport_config : public base::transport_config {
+        typedef typename type::concurrency_type concurrency_type;
+        typedef typename type::alog_type alog_type;
+        typedef typename type::elog_type elog_type;
+        typedef typename type::request_type request_type;
+        typedef typename type::response_type response_type;
+        typedef socket_policy socket_type;
+    };
+
+    typedef websocketpp::transport::asio::endpoint<transport_config> transport_type;
+};
+
+typedef client_config<websocketpp::config::asio_client, plain::endpoint> plain_client_config;
+typedef client_config<websocketpp::config::asio_tls_client, tls::endpoint> tls_client_config;
+
+} // namespace timestamped_transport
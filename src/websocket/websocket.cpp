@@ -1,39 +1,73 @@
 #include <websocket/websocket.h>
 #include <lib/utilities.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
 /// connection_metadata
 
-connection_metadata::connection_metadata(con_id_type id, websocketpp::connection_hdl hdl, std::string uri)
+connection_metadata::connection_metadata(con_id_type id, websocketpp::connection_hdl hdl, std::string uri, bool secure, const endpoint_options& options)
     : m_id(id)
     , m_hdl(hdl)
     , m_status(WS_INIT_STATUS)
     , m_uri(uri)
-    , m_server("N/A") {}
-
-void connection_metadata::on_open(client * c, websocketpp::connection_hdl hdl) {
+    , m_secure(secure)
+    , m_server("N/A")
+    , m_messages(options.message_history)
+    , m_kernel_timestamps(options.kernel_timestamps)
+    , m_busy_poll_us(options.busy_poll_us) {}
+
+template <typename client_type>
+void connection_metadata::on_open(client_type * c, websocketpp::connection_hdl hdl) {
     m_status = WS_OPEN_STATUS;
 
-    client::connection_ptr con = c->get_con_from_hdl(hdl);
+    typename client_type::connection_ptr con = c->get_con_from_hdl(hdl);
     m_server = con->get_response_header("Server");
+
+#ifdef __linux__
+    int fd = con->get_raw_socket().native_handle();
+
+    if (m_busy_poll_us > 0 && setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &m_busy_poll_us, sizeof(m_busy_poll_us)) != 0)
+        APP_LOG(log_flags::ws, "> Failed to enable SO_BUSY_POLL: " << std::strerror(errno));
+
+    // only the timestamped clients read through timestamped_tcp_socket
+    if constexpr (std::is_same<std::decay_t<decltype(con->get_next_layer())>, timestamped_tcp_socket>::value) {
+        timestamped_tcp_socket& socket = con->get_next_layer();
+
+        if (socket.enable_kernel_timestamps())
+            m_timestamped_socket = &socket;
+        else
+            APP_LOG(log_flags::ws, "> Failed to enable SO_TIMESTAMPNS: " << std::strerror(errno));
+    }
+#endif
 }
 
-void connection_metadata::on_fail(client * c, websocketpp::connection_hdl hdl) {
+template <typename client_type>
+void connection_metadata::on_fail(client_type * c, websocketpp::connection_hdl hdl) {
     m_status = WS_FAIL_STATUS;
 
     APP_LOG(log_flags::ws, "Connection Failed");
 
-    client::connection_ptr con = c->get_con_from_hdl(hdl);
+    typename client_type::connection_ptr con = c->get_con_from_hdl(hdl);
     m_server = con->get_response_header("Server");
     m_error_reason = con->get_ec().message();
 }
 
-void connection_metadata::on_close(client * c, websocketpp::connection_hdl hdl) {
+template <typename client_type>
+void connection_metadata::on_close(client_type * c, websocketpp::connection_hdl hdl) {
     m_status = WS_CLOSE_STATUS;
 
-    client::connection_ptr con = c->get_con_from_hdl(hdl);
+    typename client_type::connection_ptr con = c->get_con_from_hdl(hdl);
     std::stringstream s;
 
     s << "close code: " << con->get_remote_close_code() << " (" 
@@ -42,79 +76,199 @@ void connection_metadata::on_close(client * c, websocketpp::connection_hdl hdl)
     m_error_reason = s.str();
 }
 
-void connection_metadata::on_message(client * c, websocketpp::connection_hdl hdl, message_ptr msg) {
-    if (msg->get_opcode() == websocketpp::frame::opcode::text) {
-        // m_messages.push_back("RECV: " + msg->get_payload());
-        m_latest_message = "RECV: " + msg->get_payload();
-    } else {
-        m_latest_message = "RECV: " + websocketpp::utility::to_hex(msg->get_payload());
-        // m_messages.push_back("RECV: " + websocketpp::utility::to_hex(msg->get_payload()));
+template <typename client_type>
+void connection_metadata::on_message(client_type * c, websocketpp::connection_hdl hdl, message_ptr msg) {
+    m_metrics.record_message(msg->get_payload().size(), feed_metrics::clock::now());
+
+    message_timestamps timestamps;
+    timestamps.callback_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // arrival of the last segment read from the socket, i.e. the one completing this frame
+    if (m_timestamped_socket != nullptr && m_timestamped_socket->kernel_receive_ns() != 0) {
+        timestamps.kernel_ns = m_timestamped_socket->kernel_receive_ns();
+        m_kernel_to_callback.record(timestamps.callback_ns - timestamps.kernel_ns);
     }
+
+    std::string hex_payload;
+    std::string_view payload = msg->get_payload();
+
+    if (msg->get_opcode() != websocketpp::frame::opcode::text) {
+        hex_payload = websocketpp::utility::to_hex(msg->get_payload());
+        payload = hex_payload;
+    }
+
+    m_messages.push("RECV: ", payload);
+
+    // hand the message to every consumer, each applies its own conflation policy
+    std::lock_guard<std::mutex> lock(m_subscribers_mutex);
+    for (const feed_subscriber::ptr& subscriber : m_subscribers)
+        subscriber->publish(payload, timestamps);
+}
+
+// instantiate the callbacks for every client
+template void connection_metadata::on_open<tls_client>(tls_client *, websocketpp::connection_hdl);
+template void connection_metadata::on_fail<tls_client>(tls_client *, websocketpp::connection_hdl);
+template void connection_metadata::on_close<tls_client>(tls_client *, websocketpp::connection_hdl);
+template void connection_metadata::on_message<tls_client>(tls_client *, websocketpp::connection_hdl, message_ptr);
+
+template void connection_metadata::on_open<plain_client>(plain_client *, websocketpp::connection_hdl);
+template void connection_metadata::on_fail<plain_client>(plain_client *, websocketpp::connection_hdl);
+template void connection_metadata::on_close<plain_client>(plain_client *, websocketpp::connection_hdl);
+template void connection_metadata::on_message<plain_client>(plain_client *, websocketpp::connection_hdl, message_ptr);
+
+template void connection_metadata::on_open<timestamped_tls_client>(timestamped_tls_client *, websocketpp::connection_hdl);
+template void connection_metadata::on_fail<timestamped_tls_client>(timestamped_tls_client *, websocketpp::connection_hdl);
+template void connection_metadata::on_close<timestamped_tls_client>(timestamped_tls_client *, websocketpp::connection_hdl);
+template void connection_metadata::on_message<timestamped_tls_client>(timestamped_tls_client *, websocketpp::connection_hdl, message_ptr);
+
+template void connection_metadata::on_open<timestamped_plain_client>(timestamped_plain_client *, websocketpp::connection_hdl);
+template void connection_metadata::on_fail<timestamped_plain_client>(timestamped_plain_client *, websocketpp::connection_hdl);
+template void connection_metadata::on_close<timestamped_plain_client>(timestamped_plain_client *, websocketpp::connection_hdl);
+template void connection_metadata::on_message<timestamped_plain_client>(timestamped_plain_client *, websocketpp::connection_hdl, message_ptr);
+
+void connection_metadata::record_sent_message(const std::string& message) {
+    m_messages.push("SENT: ", message);
+}
+
+void connection_metadata::add_subscriber(feed_subscriber::ptr subscriber) {
+    std::lock_guard<std::mutex> lock(m_subscribers_mutex);
+    m_subscribers.push_back(std::move(subscriber));
 }
 
-std::string& connection_metadata::record_sent_message(std::string message) {
-    m_messages.push_back("SENT: " + message);
-    return m_messages.back();
+void connection_metadata::remove_subscriber(const feed_subscriber::ptr& subscriber) {
+    std::lock_guard<std::mutex> lock(m_subscribers_mutex);
+    m_subscribers.erase(std::remove(m_subscribers.begin(), m_subscribers.end(), subscriber), m_subscribers.end());
+}
+
+void connection_metadata::close_subscribers() {
+    std::lock_guard<std::mutex> lock(m_subscribers_mutex);
+    for (const feed_subscriber::ptr& subscriber : m_subscribers)
+        subscriber->close();
+}
+
+feed_stats connection_metadata::get_feed_stats() const {
+    feed_stats stats = m_metrics.snapshot(feed_metrics::clock::now());
+
+    std::lock_guard<std::mutex> lock(m_subscribers_mutex);
+    for (const feed_subscriber::ptr& subscriber : m_subscribers)
+        stats.dropped += subscriber->stats().dropped;
+
+    return stats;
 }
 
 std::ostream & operator<<(std::ostream & out, connection_metadata const & data) {
     out << "> URI: " << data.m_uri << "\n"
         << "> Status: " << data.m_status << "\n"
         << "> Remote Server: " << (data.m_server.empty() ? "None Specified" : data.m_server) << "\n"
-        << "> Error/close reason: " << (data.m_error_reason.empty() ? "N/A" : data.m_error_reason) << "\n";
-    // out << "> Messages Processed: (" << data.m_messages.size() << ") \n\n";
+        << "> Error/close reason: " << (data.m_error_reason.empty() ? "N/A" : data.m_error_reason) << "\n"
+        << data.get_feed_stats();
+
+    if (data.m_kernel_timestamps)
+        out << "> Kernel to callback latency: " << data.get_kernel_to_callback_latency() << "\n";
 
-    // for (auto it = data.m_messages.begin(); it != data.m_messages.end(); ++it) {
-    //     out << it->substr(0, WS_MSG_TYPE_LEN); // output message type
-    //     auto msg = it->substr(WS_MSG_TYPE_LEN);
-    //     // out << msg << '\n';
+    out << "> Messages in history: (" << data.m_messages.size() << "/" << data.m_messages.capacity() << ") \n";
 
-    //     // disable prettifying for profiling
-    //     try {
-    //         json j = json::parse(msg);
-    //         out << std::setw(WS_JSON_FORMAT_WIDTH) << j << '\n';
-    //     } catch(...) {
-    //         out << msg << '\n';
-    //     }
-    // }
+    data.m_messages.for_each([&out](const std::string& message) {
+        out << message.substr(0, WS_MSG_TYPE_LEN); // output message type
 
-    out << "> Latest message: " << data.m_latest_message << "\n";
+        // truncate the payload, full books are several KiB
+        auto msg = message.substr(WS_MSG_TYPE_LEN, WS_HISTORY_PRINT_LEN);
+        out << msg << (message.size() > WS_MSG_TYPE_LEN + WS_HISTORY_PRINT_LEN ? "..." : "") << '\n';
+    });
+
+    std::lock_guard<std::mutex> lock(data.m_subscribers_mutex);
+    for (const feed_subscriber::ptr& subscriber : data.m_subscribers) {
+        subscriber_stats stats = subscriber->stats();
+        out << "> Subscriber " << subscriber->name() << ": delivered " << stats.delivered
+            << ", dropped " << stats.dropped << ", pending " << stats.pending << "\n";
+    }
 
     return out;
 }
 
 /// websocket_endpoint
 
-websocket_endpoint::websocket_endpoint(): m_next_id(0) {
-    m_endpoint.clear_access_channels(websocketpp::log::alevel::all);
-    m_endpoint.clear_error_channels(websocketpp::log::elevel::all);
+template <typename function_type>
+decltype(auto) websocket_endpoint::with_endpoint(bool secure, function_type&& function) {
+    if (m_options.kernel_timestamps) {
+        if (secure)
+            return function(m_timestamped_tls_endpoint);
+        else
+            return function(m_timestamped_plain_endpoint);
+    }
+
+    if (secure)
+        return function(m_tls_endpoint);
+    else
+        return function(m_plain_endpoint);
+}
+
+websocket_endpoint::websocket_endpoint(endpoint_options options): m_next_id(0), m_options(options) {
+    for (bool secure : {true, false}) {
+        with_endpoint(secure, [this](auto& endpoint) {
+            endpoint.clear_access_channels(websocketpp::log::alevel::all);
+            endpoint.clear_error_channels(websocketpp::log::elevel::all);
 
-    m_endpoint.init_asio();
-    m_endpoint.start_perpetual(); // run in perpetual mode
+            endpoint.init_asio(&m_io_service);
+
+            // run in perpetual mode
+            endpoint.start_perpetual();
+        });
+    }
+
+    // use tls connection for wss:// uris
+    m_tls_endpoint.set_tls_init_handler(websocketpp::lib::bind(&on_tls_init));
+    m_timestamped_tls_endpoint.set_tls_init_handler(websocketpp::lib::bind(&on_tls_init));
 
     // run endpoint on seperate thread
-    m_thread = websocketpp::lib::make_shared<websocketpp::lib::thread>(&client::run, &m_endpoint);
+    m_thread = websocketpp::lib::make_shared<websocketpp::lib::thread>([this]() {
+        apply_thread_tuning(m_options.io_thread, "websocket I/O");
+
+        if (!m_options.io_spin) {
+            m_io_service.run();
+            return;
+        }
+
+        // poll() stops the io_service once perpetual mode ends and no work is left
+        while (!m_io_service.stopped())
+            m_io_service.poll();
+    });
 }
 
 websocket_endpoint::~websocket_endpoint() {
-    m_endpoint.stop_perpetual(); // stop perpetual mode
+    for (bool secure : {true, false}) {
+        with_endpoint(secure, [this, secure](auto& endpoint) {
+            // stop perpetual mode
+            endpoint.stop_perpetual();
+
+            close_all(endpoint, secure);
+        });
+    }
+
+    // release the I/O thread if a lossless consumer stopped reading
+    for (con_list::const_iterator it = m_connection_list.begin(); it != m_connection_list.end(); ++it)
+        it->second->close_subscribers();
     
+    // wait till thread is complete
+    m_thread->join();
+}
+
+template <typename client_type>
+void websocket_endpoint::close_all(client_type& endpoint, bool secure) {
     for (con_list::const_iterator it = m_connection_list.begin(); it != m_connection_list.end(); ++it) {
         // Only close open connections
-        if (it->second->get_status() != WS_OPEN_STATUS)
+        if (it->second->is_secure() != secure || it->second->get_status() != WS_OPEN_STATUS)
             continue;
 
         APP_LOG(log_flags::ws, "> Closing connection " << it->second->get_id());
 
         websocketpp::lib::error_code ec;
-        m_endpoint.close(it->second->get_hdl(), websocketpp::close::status::going_away, "", ec);
+        endpoint.close(it->second->get_hdl(), websocketpp::close::status::going_away, "", ec);
         
         if (ec)
             APP_LOG(log_flags::ws, "> Error closing connection " << it->second->get_id() << ": " << ec.message());
     }
-    
-    // wait till thread is complete
-    m_thread->join();
 }
 
 context_ptr websocket_endpoint::on_tls_init() {
@@ -133,54 +287,67 @@ context_ptr websocket_endpoint::on_tls_init() {
 }
 
 con_id_type websocket_endpoint::connect(const std::string& uri) {
-    // use tls connection
-    m_endpoint.set_tls_init_handler(websocketpp::lib::bind(&on_tls_init));
+    websocketpp::uri parsed_uri(uri);
 
+    if (!parsed_uri.get_valid()) {
+        APP_LOG(log_flags::ws, "> Invalid uri: " << uri);
+        return WS_CON_ERR_CODE;
+    }
+
+    bool secure = parsed_uri.get_secure();
+
+    return with_endpoint(secure, [this, &uri, secure](auto& endpoint) {
+        return connect(endpoint, uri, secure);
+    });
+}
+
+template <typename client_type>
+con_id_type websocket_endpoint::connect(client_type& endpoint, const std::string& uri, bool secure) {
     websocketpp::lib::error_code ec;
     con_id_type new_id = m_next_id++;
 
-    client::connection_ptr con = m_endpoint.get_connection(uri, ec);
+    typename client_type::connection_ptr con = endpoint.get_connection(uri, ec);
 
     if (ec) {
         APP_LOG(log_flags::ws, "> Connect initialization error: " << ec.message());
         return WS_CON_ERR_CODE;
     }
 
-    connection_metadata::ptr metadata_ptr = websocketpp::lib::make_shared<connection_metadata>(new_id, con->get_handle(), uri);
+    connection_metadata::ptr metadata_ptr = websocketpp::lib::make_shared<connection_metadata>(new_id, con->get_handle(), uri, secure, m_options);
     m_connection_list[new_id] = metadata_ptr; // store the connection and associated metadata
 
     // register callbacks
     con->set_open_handler(websocketpp::lib::bind(
-        &connection_metadata::on_open,
+        &connection_metadata::on_open<client_type>,
         metadata_ptr,
-        &m_endpoint,
+        &endpoint,
         websocketpp::lib::placeholders::_1
     ));
 
     con->set_fail_handler(websocketpp::lib::bind(
-        &connection_metadata::on_fail,
+        &connection_metadata::on_fail<client_type>,
         metadata_ptr,
-        &m_endpoint,
+        &endpoint,
         websocketpp::lib::placeholders::_1
     ));
 
     con->set_close_handler(websocketpp::lib::bind(
-        &connection_metadata::on_close,
+        &connection_metadata::on_close<client_type>,
         metadata_ptr,
-        &m_endpoint,
+        &endpoint,
         websocketpp::lib::placeholders::_1
     ));
 
     con->set_message_handler(websocketpp::lib::bind(
-        &connection_metadata::on_message,
+        &connection_metadata::on_message<client_type>,
         metadata_ptr,
-        &m_endpoint,
+        &endpoint,
         websocketpp::lib::placeholders::_1,
         websocketpp::lib::placeholders::_2
     ));
 
     // intialize connection
-    m_endpoint.connect(con);
+    endpoint.connect(con);
 
     return new_id;
 }
@@ -195,7 +362,9 @@ void websocket_endpoint::close(con_id_type id, websocketpp::close::status::value
         return;
     }
 
-    m_endpoint.close(metadata_it->second->get_hdl(), code, reason, ec);
+    with_endpoint(metadata_it->second->is_secure(), [&](auto& endpoint) {
+        endpoint.close(metadata_it->second->get_hdl(), code, reason, ec);
+    });
     
     if (ec)
        APP_LOG(log_flags::ws, "> Error initiating close: " << ec.message());
@@ -215,7 +384,9 @@ websocket_endpoint::send_result websocket_endpoint::send(con_id_type id, std::st
     }
     
     // send message
-    m_endpoint.send(metadata_it->second->get_hdl(), message, websocketpp::frame::opcode::text, ec);
+    with_endpoint(metadata_it->second->is_secure(), [&](auto& endpoint) {
+        endpoint.send(metadata_it->second->get_hdl(), message, websocketpp::frame::opcode::text, ec);
+    });
 
     if (ec) {
         APP_LOG(log_flags::ws, "> Error sending message: " << ec.message());
@@ -241,12 +412,48 @@ connection_metadata::ptr websocket_endpoint::get_metadata(con_id_type id) const
         return metadata_it->second;
 }
 
-std::string* websocket_endpoint::get_latest_message(con_id_type id) {
-    con_list::const_iterator metadata_it = m_connection_list.find(id);
+feed_subscriber::ptr websocket_endpoint::subscribe(con_id_type id, std::string name, subscriber_options options) {
+    feed_subscriber::ptr subscriber = websocketpp::lib::make_shared<feed_subscriber>(std::move(name), options);
 
-    if (metadata_it == m_connection_list.end())
+    if (!subscribe(id, subscriber))
         return nullptr;
-    
-    // return &(metadata_it->second->m_messages.back());
-    return &metadata_it->second->m_latest_message;
-}
\ No newline at end of file
+
+    return subscriber;
+}
+
+bool websocket_endpoint::subscribe(con_id_type id, feed_subscriber::ptr subscriber) {
+    connection_metadata::ptr metadata_ptr = get_metadata(id);
+
+    if (!metadata_ptr) {
+        APP_LOG(log_flags::ws, "> No connection found with id " << id);
+        return false;
+    }
+
+    metadata_ptr->add_subscriber(std::move(subscriber));
+    return true;
+}
+
+void websocket_endpoint::unsubscribe(con_id_type id, const feed_subscriber::ptr& subscriber) {
+    connection_metadata::ptr metadata_ptr = get_metadata(id);
+
+    if (metadata_ptr)
+        metadata_ptr->remove_subscriber(subscriber);
+}
+
+feed_stats websocket_endpoint::get_feed_stats(con_id_type id) const {
+    connection_metadata::ptr metadata_ptr = get_metadata(id);
+
+    if (!metadata_ptr)
+        return feed_stats{};
+
+    return metadata_ptr->get_feed_stats();
+}
+
+latency_summary websocket_endpoint::get_kernel_to_callback_latency(con_id_type id) const {
+    connection_metadata::ptr metadata_ptr = get_metadata(id);
+
+    if (!metadata_ptr)
+        return latency_summary{};
+
+    return metadata_ptr->get_kernel_to_callback_latency();
+}
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <websocketpp/config/asio_client.hpp>
+#include <websocketpp/config/asio_no_tls_client.hpp>
 #include <websocketpp/client.hpp>
+#include <websocket/timestamped_transport.h>
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
 #include <boost/asio/ssl/context.hpp> 
@@ -17,6 +19,11 @@
 #include <sstream>
 
 #include <lib/benchmark.h>
+#include <lib/thread_tuning.h>
+#include <lib/latency.h>
+#include <websocket/feed_metrics.h>
+#include <websocket/message_ring.h>
+#include <websocket/feed_subscriber.h>
 // global benchmark object
 extern benchmark g_benchmark;
 
@@ -30,31 +37,71 @@ using con_id_type = int;
 constexpr int WS_CON_ERR_CODE = -1;
 constexpr unsigned int WS_MSG_TYPE_LEN = 6; // 'SENT: ' or 'RECV: '
 constexpr unsigned int WS_JSON_FORMAT_WIDTH = 4;
+constexpr unsigned int WS_HISTORY_PRINT_LEN = 200;
+
+// wss:// connections use the tls client, ws:// connections the plain client
+typedef websocketpp::client<websocketpp::config::asio_tls_client> tls_client;
+typedef websocketpp::client<websocketpp::config::asio_client> plain_client;
+
+// same clients reading through timestamped_tcp_socket for the kernel arrival times, only used
+// with endpoint_options::kernel_timestamps
+typedef websocketpp::client<timestamped_transport::tls_client_config> timestamped_tls_client;
+typedef websocketpp::client<timestamped_transport::plain_client_config> timestamped_plain_client;
 
-typedef websocketpp::client<websocketpp::config::asio_tls_client> client;
 typedef std::shared_ptr<boost::asio::ssl::context> context_ptr;
-typedef client::message_ptr message_ptr;
+typedef tls_client::message_ptr message_ptr;
+
+static_assert(std::is_same<message_ptr, plain_client::message_ptr>::value
+    && std::is_same<message_ptr, timestamped_tls_client::message_ptr>::value
+    && std::is_same<message_ptr, timestamped_plain_client::message_ptr>::value,
+    "all clients must share the message type");
+
+// endpoint wide options
+struct endpoint_options {
+    // enable SO_TIMESTAMPNS and attribute a kernel arrival time to each frame (linux only), read
+    // from the SCM_TIMESTAMPNS control message of the socket reads. Selects the timestamped clients
+    // for every connection of the endpoint
+    bool kernel_timestamps = false;
+
+    // recent messages (both directions) kept per connection
+    size_t message_history = WS_HISTORY_CAPACITY;
+
+    // cpu and scheduling policy of the I/O thread
+    thread_tuning io_thread;
+
+    // SO_BUSY_POLL in microseconds for each socket, 0 disables (raising it needs CAP_NET_ADMIN)
+    int busy_poll_us = 0;
+
+    // spin the I/O thread with poll() instead of sleeping in run(), trading a core for wakeup latency
+    bool io_spin = false;
+};
 
 class connection_metadata {
 public:
     typedef websocketpp::lib::shared_ptr<connection_metadata> ptr;
 
     // constructor
-    connection_metadata(con_id_type id, websocketpp::connection_hdl hdl, std::string uri);
+    connection_metadata(con_id_type id, websocketpp::connection_hdl hdl, std::string uri, bool secure, const endpoint_options& options);
 
     // callback functions
-    void on_open(client * c, websocketpp::connection_hdl hdl);
-    void on_fail(client * c, websocketpp::connection_hdl hdl);
-    void on_close(client * c, websocketpp::connection_hdl hdl);
-    void on_message(client * c, websocketpp::connection_hdl hdl, message_ptr msg);
+    template <typename client_type> void on_open(client_type * c, websocketpp::connection_hdl hdl);
+    template <typename client_type> void on_fail(client_type * c, websocketpp::connection_hdl hdl);
+    template <typename client_type> void on_close(client_type * c, websocketpp::connection_hdl hdl);
+    template <typename client_type> void on_message(client_type * c, websocketpp::connection_hdl hdl, message_ptr msg);
 
     // modifiers
-    std::string& record_sent_message(std::string message);
+    void record_sent_message(const std::string& message);
+    void add_subscriber(feed_subscriber::ptr subscriber);
+    void remove_subscriber(const feed_subscriber::ptr& subscriber);
+    void close_subscribers();
 
     // getters / setters
     websocketpp::connection_hdl get_hdl() const { return m_hdl; }
     con_id_type get_id() const { return m_id; }
     std::string get_status() const { return m_status; }
+    bool is_secure() const { return m_secure; }
+    feed_stats get_feed_stats() const;
+    latency_summary get_kernel_to_callback_latency() const { return m_kernel_to_callback.summary(); }
 
     // operator methods
     friend std::ostream & operator<<(std::ostream & out, connection_metadata const & data);
@@ -64,10 +111,22 @@ private:
     websocketpp::connection_hdl m_hdl;
     std::string m_status;
     std::string m_uri;
+    bool m_secure;
     std::string m_server;
     std::string m_error_reason;
-    std::vector<std::string> m_messages;
-    std::string m_latest_message;
+    message_ring m_messages;
+
+    // consumers of the received messages, each with its own conflation policy
+    mutable std::mutex m_subscribers_mutex;
+    std::vector<feed_subscriber::ptr> m_subscribers;
+
+    feed_metrics m_metrics;
+
+    // kernel arrival to on_message dispatch, includes tls decrypt and queueing
+    bool m_kernel_timestamps;
+    int m_busy_poll_us;
+    const timestamped_tcp_socket* m_timestamped_socket = nullptr; // set once timestamps are enabled
+    rolling_latency m_kernel_to_callback;
 };
 
 class websocket_endpoint {
@@ -78,27 +137,51 @@ public:
     };
 
     // constructor
-    websocket_endpoint();
+    websocket_endpoint(endpoint_options options = {});
 
     // destructor
     ~websocket_endpoint();
 
     // modifiers
+    // the uri scheme selects the transport: wss:// uses tls, ws:// a plain tcp socket
     con_id_type connect(const std::string& uri);
     void close(con_id_type id, websocketpp::close::status::value code, std::string reason);
     send_result send(con_id_type id, std::string message);
     connection_metadata::ptr get_metadata(con_id_type id) const;
 
-    std::string* get_latest_message(con_id_type id);
+    // attach a consumer to the connection's message stream, nullptr if the connection is unknown
+    feed_subscriber::ptr subscribe(con_id_type id, std::string name, subscriber_options options = {});
+    bool subscribe(con_id_type id, feed_subscriber::ptr subscriber);
+    void unsubscribe(con_id_type id, const feed_subscriber::ptr& subscriber);
+
+    feed_stats get_feed_stats(con_id_type id) const;
+    latency_summary get_kernel_to_callback_latency(con_id_type id) const;
 
     // callbacks
     static context_ptr on_tls_init();
 private:
     typedef std::map<con_id_type, connection_metadata::ptr> con_list;
 
-    client m_endpoint;
-    
+    template <typename client_type>
+    con_id_type connect(client_type& endpoint, const std::string& uri, bool secure);
+
+    template <typename client_type>
+    void close_all(client_type& endpoint, bool secure);
+
+    // calls function with the client serving secure or plain connections, the timestamped ones
+    // when kernel timestamps are enabled
+    template <typename function_type>
+    decltype(auto) with_endpoint(bool secure, function_type&& function);
+
+    // the endpoints share one io_service, so a single thread serves every connection
+    websocketpp::lib::asio::io_service m_io_service;
+    tls_client m_tls_endpoint;
+    plain_client m_plain_endpoint;
+    timestamped_tls_client m_timestamped_tls_endpoint;
+    timestamped_plain_client m_timestamped_plain_endpoint;
+
     websocketpp::lib::shared_ptr<websocketpp::lib::thread> m_thread;
     con_list m_connection_list;
     con_id_type m_next_id;
+    endpoint_options m_options;
 };
\ No newline at end of file